@@ -0,0 +1,85 @@
+#include "rmf/rmf-private.h"
+
+#include <glib.h>
+#include <stdalign.h>
+#include <stddef.h>
+
+// Chunks are at least this big. Bigger requests get a chunk of their own.
+static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+typedef struct _RmfArenaChunk Chunk;
+typedef struct _RmfArenaKeep Keep;
+
+// Chunks are only listed to be freed, so their order does not matter.
+struct _RmfArenaChunk {
+    Chunk *next;
+    alignas(max_align_t) guint8 data[];
+};
+
+// Something kept alive by the arena, allocated from the arena itself.
+struct _RmfArenaKeep {
+    Keep *next;
+    gpointer data;
+    GDestroyNotify destroy;
+};
+
+static void arena_clear(RmfArena *self)
+{
+    for (Keep *keep = self->keep; keep != nullptr; keep = keep->next) {
+        keep->destroy(keep->data);
+    }
+    Chunk *chunk = self->head;
+    while (chunk != nullptr) {
+        Chunk *next = chunk->next;
+        g_free(chunk);
+        chunk = next;
+    }
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// A bump allocator for the records of one load. Records are never freed one by
+// one; they all go at once with the last reference to the arena. Arenas are
+// not thread-safe, so each thread parsing a load has its own.
+RmfArena *rmf_arena_new(void)
+{
+    return g_atomic_rc_box_new0(RmfArena);
+}
+
+RmfArena *rmf_arena_ref(RmfArena *self)
+{
+    return g_atomic_rc_box_acquire(self);
+}
+
+void rmf_arena_unref(RmfArena *self)
+{
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)arena_clear);
+}
+
+// Keep @data alive until the arena goes, then pass it to @destroy. Used for
+// whatever records point into, such as the pool their strings are interned in.
+void rmf_arena_keep(RmfArena *self, gpointer data, GDestroyNotify destroy)
+{
+    Keep *keep = rmf_arena_alloc_aligned(self, sizeof(Keep), alignof(Keep));
+    *keep = (Keep){
+        .next = self->keep,
+        .data = data,
+        .destroy = destroy,
+    };
+    self->keep = keep;
+}
+
+gpointer rmf_arena_alloc_slow(RmfArena *self, size_t size)
+{
+    auto const chunk_size = MAX(size, CHUNK_SIZE);
+    Chunk *chunk = g_malloc(sizeof(Chunk) + chunk_size);
+    chunk->next = self->head;
+    self->head = chunk;
+
+    // A chunk just for a big request leaves the current chunk in use.
+    if (chunk_size == CHUNK_SIZE) {
+        self->pos = chunk->data + size;
+        self->end = chunk->data + chunk_size;
+    }
+    return chunk->data;
+}
@@ -0,0 +1,592 @@
+#include "rmf/rmf-bvh.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfBvh:
+ *
+ * A bounding volume hierarchy over the solids and point entities of an
+ * [struct@RmfModel], for finding the objects in a region or around a point
+ * without scanning the whole map.
+ *
+ * Solids are indexed by their bounds and point entities by their origin. The
+ * worldspawn, groups and brush entities are left out, as their bounds are
+ * those of their solids. Queries return node indices into the model, which
+ * [method@RmfModel.get_object] makes objects of. Queries which list objects
+ * also list each brush entity once, after the solids, if any of its solids is
+ * found.
+ *
+ * The tree is built top-down, splitting each range of objects where the
+ * binned surface area heuristic says it is cheapest. Large ranges have their
+ * two halves built in parallel.
+ */
+G_DEFINE_BOXED_TYPE(RmfBvh, rmf_bvh, rmf_bvh_ref, rmf_bvh_unref)
+
+// Most objects in a leaf.
+#define LEAF_SIZE 4
+
+// Number of bins the surface area heuristic tries splits between.
+#define N_BINS 16
+
+// Fewest objects in a range before its halves are built in parallel.
+#define PARALLEL_THRESHOLD 4096
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Build state of a range of objects, which is turned into node @node. The
+// subtree of a range of n objects takes up to 2n - 1 nodes, which are kept for
+// it from @node on, so that subtrees can be built in parallel without sharing
+// anything.
+typedef struct {
+    RmfBvh *bvh;
+    RmfVector *centroids; // Of each object, in the same order.
+    rmf_int node;
+    rmf_int begin;
+    rmf_int end;
+    rmf_int depth; // Set by build() to the depth of the subtree.
+} Build;
+
+typedef struct {
+    RmfBounds bounds;
+    rmf_int count;
+} Bin;
+
+static void build(Build *task);
+
+static float half_area(RmfBounds const *bounds)
+{
+    if (rmf_bounds_is_empty(bounds)) {
+        return 0.0f;
+    }
+    auto const dx = bounds->max.x - bounds->min.x;
+    auto const dy = bounds->max.y - bounds->min.y;
+    auto const dz = bounds->max.z - bounds->min.z;
+    return dx * dy + dy * dz + dz * dx;
+}
+
+static float axis_of(RmfVector const *v, int axis)
+{
+    return axis == 0 ? v->x : axis == 1 ? v->y : v->z;
+}
+
+static void swap_objects(Build const *task, rmf_int i, rmf_int j)
+{
+    auto const bvh = task->bvh;
+    auto const index = bvh->objects[i];
+    bvh->objects[i] = bvh->objects[j];
+    bvh->objects[j] = index;
+    auto const bounds = bvh->bounds[i];
+    bvh->bounds[i] = bvh->bounds[j];
+    bvh->bounds[j] = bounds;
+    auto const centroid = task->centroids[i];
+    task->centroids[i] = task->centroids[j];
+    task->centroids[j] = centroid;
+}
+
+// Pick the split of @task with the lowest surface area heuristic cost, as an
+// axis and a bin boundary. Returns false if all centroids coincide.
+static bool find_split(
+    Build const *task,
+    RmfBounds const *centroid_bounds,
+    int *split_axis,
+    float *split_position
+)
+{
+    float best_cost = G_MAXFLOAT;
+    for (int axis = 0; axis < 3; ++axis) {
+        auto const lo = axis_of(&centroid_bounds->min, axis);
+        auto const extent = axis_of(&centroid_bounds->max, axis) - lo;
+        if (!(extent > 0.0f)) {
+            continue;
+        }
+        auto const scale = N_BINS / extent;
+
+        Bin bins[N_BINS];
+        for (int b = 0; b < N_BINS; ++b) {
+            rmf_bounds_clear(&bins[b].bounds);
+            bins[b].count = 0;
+        }
+        for (rmf_int i = task->begin; i < task->end; ++i) {
+            auto const c = axis_of(&task->centroids[i], axis);
+            auto const b = MIN((int)((c - lo) * scale), N_BINS - 1);
+            rmf_bounds_union(&bins[b].bounds, &task->bvh->bounds[i]);
+            bins[b].count++;
+        }
+
+        // Sweep from the right, then from the left, to cost every boundary.
+        float right_area[N_BINS];
+        rmf_int right_count[N_BINS];
+        RmfBounds acc;
+        rmf_bounds_clear(&acc);
+        rmf_int count = 0;
+        for (int b = N_BINS - 1; b > 0; --b) {
+            rmf_bounds_union(&acc, &bins[b].bounds);
+            count += bins[b].count;
+            right_area[b] = half_area(&acc);
+            right_count[b] = count;
+        }
+        rmf_bounds_clear(&acc);
+        count = 0;
+        for (int b = 1; b < N_BINS; ++b) {
+            rmf_bounds_union(&acc, &bins[b - 1].bounds);
+            count += bins[b - 1].count;
+            auto const cost
+                = half_area(&acc) * count + right_area[b] * right_count[b];
+            if (count > 0 && right_count[b] > 0 && cost < best_cost) {
+                best_cost = cost;
+                *split_axis = axis;
+                *split_position = lo + b / scale;
+            }
+        }
+    }
+    return best_cost < G_MAXFLOAT;
+}
+
+static void build_parallel(guint begin, guint end, guint, gpointer user_data)
+{
+    Build *tasks = user_data;
+    for (guint i = begin; i < end; ++i) {
+        build(&tasks[i]);
+    }
+}
+
+static void build(Build *task)
+{
+    auto const bvh = task->bvh;
+    auto const node = &bvh->nodes[task->node];
+    auto const n = task->end - task->begin;
+
+    RmfBounds centroid_bounds;
+    rmf_bounds_clear(&node->bounds);
+    rmf_bounds_clear(&centroid_bounds);
+    for (rmf_int i = task->begin; i < task->end; ++i) {
+        rmf_bounds_union(&node->bounds, &bvh->bounds[i]);
+        auto const c = task->centroids[i];
+        rmf_bounds_union(&centroid_bounds, &(RmfBounds){c, c});
+    }
+
+    int axis = 0;
+    float position = 0.0f;
+    if (n <= LEAF_SIZE
+        || !find_split(task, &centroid_bounds, &axis, &position))
+    {
+        node->first = task->begin;
+        node->count = n;
+        task->depth = 1;
+        return;
+    }
+
+    // Partition around the split. Centroids on a bin boundary may round
+    // either way, so fall back to halving if one side ends up empty.
+    auto mid = task->begin;
+    for (rmf_int i = task->begin; i < task->end; ++i) {
+        if (axis_of(&task->centroids[i], axis) < position) {
+            swap_objects(task, i, mid++);
+        }
+    }
+    if (mid == task->begin || mid == task->end) {
+        mid = task->begin + n / 2;
+    }
+
+    auto const n_left = mid - task->begin;
+    Build children[2] = {
+        {
+            .bvh = bvh,
+            .centroids = task->centroids,
+            .node = task->node + 1,
+            .begin = task->begin,
+            .end = mid,
+        },
+        {
+            .bvh = bvh,
+            .centroids = task->centroids,
+            .node = task->node + 2 * n_left,
+            .begin = mid,
+            .end = task->end,
+        },
+    };
+    node->first = children[1].node;
+    node->count = 0;
+
+    if (n >= PARALLEL_THRESHOLD) {
+        rmf_parallel_for(2, 1, build_parallel, children);
+    } else {
+        build(&children[0]);
+        build(&children[1]);
+    }
+    task->depth = 1 + MAX(children[0].depth, children[1].depth);
+}
+
+// Get the bounds an object is indexed by, if node @index is one.
+static bool get_object_bounds(RmfModel *model, rmf_int index, RmfBounds *out)
+{
+    auto const node = rmf_model_node(model, index);
+    switch ((RmfObjectType)node->object_type) {
+    case RMF_OBJECT_TYPE_SOLID:
+        *out = g_array_index(model->bounds, RmfBounds, index);
+        return !rmf_bounds_is_empty(out);
+    case RMF_OBJECT_TYPE_ENTITY:
+        if (node->n_children > 0) {
+            return false;
+        }
+        auto const origin = rmf_model_entity(model, node->payload)->origin;
+        *out = (RmfBounds){origin, origin};
+        return true;
+    case RMF_OBJECT_TYPE_WORLD:
+    case RMF_OBJECT_TYPE_GROUP:
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+    return false;
+}
+
+// The plane through @face's plane points, facing away from @inside.
+static void make_plane(
+    RmfBvhHulls *hulls,
+    rmf_int i,
+    RmfFace const *face,
+    RmfVector const *inside
+)
+{
+    RmfPlane plane;
+    if (!rmf_plane_from_face(&plane, face, inside)) {
+        // Degenerate, so make it a plane which holds back nothing.
+        plane = (RmfPlane){.normal = {0.0f, 0.0f, 0.0f}, .distance = 1.0f};
+    }
+    hulls->nx[i] = plane.normal.x;
+    hulls->ny[i] = plane.normal.y;
+    hulls->nz[i] = plane.normal.z;
+    hulls->d[i] = plane.distance;
+}
+
+// Work out the planes and vertices of every solid. Which way plane points wind
+// differs between editors, so each plane is turned to face away from the
+// average of the solid's vertices, which lies inside a convex solid.
+static RmfBvhHulls *make_hulls(RmfBvh *self)
+{
+    auto const model = self->model;
+    RmfBvhHulls *hulls = g_new0(RmfBvhHulls, 1);
+    hulls->first = g_new(rmf_int, self->n_objects + 1);
+    hulls->first_vertex = g_new(rmf_int, self->n_objects + 1);
+
+    g_autoptr(GPtrArray) all_faces = g_ptr_array_new();
+    rmf_int n_planes = 0;
+    rmf_int n_vertices = 0;
+    for (rmf_int i = 0; i < self->n_objects; ++i) {
+        hulls->first[i] = n_planes;
+        hulls->first_vertex[i] = n_vertices;
+        auto const index = self->objects[i];
+        GPtrArray *faces = nullptr;
+        if (rmf_model_node(model, index)->object_type
+            == RMF_OBJECT_TYPE_SOLID)
+        {
+            faces = rmf_model_get_solid_faces(model, index);
+        }
+        g_ptr_array_add(all_faces, faces);
+        for (guint j = 0; faces != nullptr && j < faces->len; ++j) {
+            RmfFace const *face = g_ptr_array_index(faces, j);
+            n_vertices += face->n_vertices;
+        }
+        n_planes += faces ? faces->len : 0;
+    }
+    hulls->first[self->n_objects] = n_planes;
+    hulls->first_vertex[self->n_objects] = n_vertices;
+
+    hulls->nx = g_new(rmf_float, n_planes);
+    hulls->ny = g_new(rmf_float, n_planes);
+    hulls->nz = g_new(rmf_float, n_planes);
+    hulls->d = g_new(rmf_float, n_planes);
+    hulls->plane_vertex = g_new(rmf_int, n_planes + 1);
+    hulls->plane_vertex[n_planes] = n_vertices;
+    hulls->vx = g_new(rmf_float, n_vertices);
+    hulls->vy = g_new(rmf_float, n_vertices);
+    hulls->vz = g_new(rmf_float, n_vertices);
+    for (rmf_int i = 0; i < self->n_objects; ++i) {
+        GPtrArray *faces = g_ptr_array_index(all_faces, i);
+        if (faces == nullptr || faces->len == 0) {
+            continue;
+        }
+        RmfVector inside = {};
+        auto v = hulls->first_vertex[i];
+        for (guint j = 0; j < faces->len; ++j) {
+            RmfFace const *face = g_ptr_array_index(faces, j);
+            hulls->plane_vertex[hulls->first[i] + j] = v;
+            for (rmf_int k = 0; k < face->n_vertices; ++k, ++v) {
+                hulls->vx[v] = face->vertices[k].x;
+                hulls->vy[v] = face->vertices[k].y;
+                hulls->vz[v] = face->vertices[k].z;
+                inside.x += face->vertices[k].x;
+                inside.y += face->vertices[k].y;
+                inside.z += face->vertices[k].z;
+            }
+        }
+        auto const n = v - hulls->first_vertex[i];
+        if (n > 0) {
+            inside = (RmfVector){inside.x / n, inside.y / n, inside.z / n};
+        }
+        for (guint j = 0; j < faces->len; ++j) {
+            auto const face = g_ptr_array_index(faces, j);
+            make_plane(hulls, hulls->first[i] + j, face, &inside);
+        }
+    }
+    return hulls;
+}
+
+static void hulls_free(RmfBvhHulls *hulls)
+{
+    g_free(hulls->nx);
+    g_free(hulls->ny);
+    g_free(hulls->nz);
+    g_free(hulls->d);
+    g_free(hulls->first);
+    g_free(hulls->vx);
+    g_free(hulls->vy);
+    g_free(hulls->vz);
+    g_free(hulls->first_vertex);
+    g_free(hulls->plane_vertex);
+    g_free(hulls);
+}
+
+static void bvh_clear(RmfBvh *self)
+{
+    g_clear_pointer(&self->hulls, hulls_free);
+    g_free(self->nodes);
+    g_free(self->objects);
+    g_free(self->bounds);
+    rmf_model_unref(self->model);
+}
+
+static bool overlaps(RmfBounds const *a, RmfBounds const *b)
+{
+    return a->min.x <= b->max.x && b->min.x <= a->max.x
+        && a->min.y <= b->max.y && b->min.y <= a->max.y
+        && a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_bvh_new:
+ * @model: The model to index. Its load must have succeeded.
+ *
+ * Builds a bounding volume hierarchy over the solids and point entities of a
+ * model.
+ *
+ * Returns: (transfer full): The new hierarchy.
+ */
+RmfBvh *rmf_bvh_new(RmfModel *model)
+{
+    g_return_val_if_fail(model != nullptr, nullptr);
+    g_return_val_if_fail(model->bounds->len == model->nodes->len, nullptr);
+
+    RmfBvh *self = g_atomic_rc_box_new0(RmfBvh);
+    self->model = rmf_model_ref(model);
+
+    rmf_int n = 0;
+    RmfBounds b;
+    for (rmf_int i = 0; i < model->nodes->len; ++i) {
+        n += get_object_bounds(model, i, &b);
+    }
+    self->n_objects = n;
+    if (n == 0) {
+        return self;
+    }
+
+    self->objects = g_new(rmf_int, n);
+    self->bounds = g_new(RmfBounds, n);
+    g_autofree RmfVector *centroids = g_new(RmfVector, n);
+    rmf_int j = 0;
+    for (rmf_int i = 0; i < model->nodes->len; ++i) {
+        if (!get_object_bounds(model, i, &b)) {
+            continue;
+        }
+        self->bounds[j] = b;
+        centroids[j] = (RmfVector){
+            (b.min.x + b.max.x) * 0.5f,
+            (b.min.y + b.max.y) * 0.5f,
+            (b.min.z + b.max.z) * 0.5f,
+        };
+        self->objects[j++] = i;
+    }
+
+    self->n_nodes = 2 * n - 1;
+    self->nodes = g_new0(RmfBvhNode, self->n_nodes);
+    Build root = {
+        .bvh = self,
+        .centroids = centroids,
+        .node = 0,
+        .begin = 0,
+        .end = n,
+    };
+    build(&root);
+    self->depth = root.depth;
+    return self;
+}
+
+/**
+ * rmf_bvh_ref:
+ * @bvh: The hierarchy.
+ *
+ * Increases the reference count of a bounding volume hierarchy.
+ *
+ * Returns: (transfer full): The hierarchy.
+ */
+RmfBvh *rmf_bvh_ref(RmfBvh *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_bvh_unref:
+ * @bvh: (transfer full): The hierarchy.
+ *
+ * Decreases the reference count of a bounding volume hierarchy, freeing it
+ * when it reaches zero.
+ */
+void rmf_bvh_unref(RmfBvh *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)bvh_clear);
+}
+
+/**
+ * rmf_bvh_get_model:
+ * @bvh: The hierarchy.
+ *
+ * Gets the model the hierarchy indexes.
+ *
+ * Returns: (transfer none): The model.
+ */
+RmfModel *rmf_bvh_get_model(RmfBvh *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return self->model;
+}
+
+/**
+ * rmf_bvh_query_box:
+ * @bvh: The hierarchy.
+ * @bounds: The region to look in.
+ * @results: (element-type guint32): Array to append the node indices of the
+ *   objects touching @bounds to.
+ *
+ * Finds the objects whose bounds overlap a region, touching included.
+ *
+ * Returns: The number of objects found.
+ */
+guint
+rmf_bvh_query_box(RmfBvh *self, RmfBounds const *bounds, GArray *results)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_return_val_if_fail(bounds != nullptr, 0);
+    g_return_val_if_fail(results != nullptr, 0);
+    if (self->n_nodes == 0) {
+        return 0;
+    }
+
+    // A walk keeps at most one pending sibling per level.
+    rmf_int stack_buf[64];
+    g_autofree rmf_int *stack_heap = nullptr;
+    auto stack = stack_buf;
+    if (self->depth >= G_N_ELEMENTS(stack_buf)) {
+        stack = stack_heap = g_new(rmf_int, self->depth + 1);
+    }
+
+    auto const len = results->len;
+    guint top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        auto const index = stack[--top];
+        auto const node = &self->nodes[index];
+        if (!overlaps(&node->bounds, bounds)) {
+            continue;
+        }
+        if (node->count == 0) {
+            stack[top++] = node->first;
+            stack[top++] = index + 1;
+            continue;
+        }
+        for (rmf_int i = node->first; i < node->first + node->count; ++i) {
+            if (overlaps(&self->bounds[i], bounds)) {
+                g_array_append_val(results, self->objects[i]);
+            }
+        }
+    }
+    rmf_bvh_add_brush_entities(self, results, len);
+    return results->len - len;
+}
+
+/**
+ * rmf_bvh_query_point:
+ * @bvh: The hierarchy.
+ * @point: The point to look at.
+ * @results: (element-type guint32): Array to append the node indices of the
+ *   objects containing @point to.
+ *
+ * Finds the objects whose bounds contain a point, boundary included.
+ *
+ * Returns: The number of objects found.
+ */
+guint
+rmf_bvh_query_point(RmfBvh *self, RmfVector const *point, GArray *results)
+{
+    g_return_val_if_fail(point != nullptr, 0);
+    RmfBounds const bounds = {*point, *point};
+    return rmf_bvh_query_box(self, &bounds, results);
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Get the convex hulls of the objects, working them out on the first call.
+RmfBvhHulls const *rmf_bvh_get_hulls(RmfBvh *self)
+{
+    if (g_once_init_enter(&self->hulls)) {
+        g_once_init_leave(&self->hulls, make_hulls(self));
+    }
+    return self->hulls;
+}
+
+// Append the brush entities of the solids in @results from @begin on, which
+// aren't in the BVH themselves, each once. Every query which lists objects
+// calls this, so that brush entities are found alike by all of them.
+void rmf_bvh_add_brush_entities(RmfBvh *self, GArray *results, guint begin)
+{
+    auto const model = self->model;
+    if (model->preorder->len == 0) {
+        return;
+    }
+    auto const entries = (RmfModelPreorderEntry const *)model->preorder->data;
+    g_autoptr(GHashTable) added = nullptr;
+    auto const end = results->len;
+    for (guint i = begin; i < end; ++i) {
+        auto const index = g_array_index(results, rmf_int, i);
+        if (rmf_model_node(model, index)->object_type
+            != RMF_OBJECT_TYPE_SOLID)
+        {
+            continue;
+        }
+        // Solids may sit in groups within their entity.
+        auto const position = g_array_index(model->positions, rmf_int, index);
+        auto parent = entries[position].parent;
+        for (; parent != RMF_MODEL_NO_PARENT; parent = entries[parent].parent) {
+            auto const node = entries[parent].node;
+            auto const object_type = rmf_model_node(model, node)->object_type;
+            if (object_type == RMF_OBJECT_TYPE_ENTITY) {
+                if (added == nullptr) {
+                    added = g_hash_table_new(nullptr, nullptr);
+                }
+                if (g_hash_table_add(added, GUINT_TO_POINTER(node))) {
+                    g_array_append_val(results, node);
+                }
+                break;
+            }
+            if (object_type == RMF_OBJECT_TYPE_WORLD) {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef RMF_BVH_H
+#define RMF_BVH_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-model.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfBvh
+
+#define RMF_TYPE_BVH rmf_bvh_get_type()
+
+typedef struct _RmfBvh RmfBvh;
+
+GType rmf_bvh_get_type(void);
+RmfBvh *rmf_bvh_new(RmfModel *model);
+RmfBvh *rmf_bvh_ref(RmfBvh *bvh);
+void rmf_bvh_unref(RmfBvh *bvh);
+RmfModel *rmf_bvh_get_model(RmfBvh *bvh);
+guint
+rmf_bvh_query_box(RmfBvh *bvh, RmfBounds const *bounds, GArray *results);
+guint
+rmf_bvh_query_point(RmfBvh *bvh, RmfVector const *point, GArray *results);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfBvh, rmf_bvh_unref)
+
+G_END_DECLS
+
+#endif
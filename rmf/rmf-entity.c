@@ -14,7 +14,6 @@
  */
 struct _RmfEntity {
     RmfEntityData parent_instance;
-    RmfVector origin;
 };
 
 enum Property {
@@ -35,10 +34,15 @@ static void rmf_entity_get_property(
     GParamSpec *pspec
 )
 {
-    auto const self = RMF_ENTITY(object);
+    auto const self = RMF_MAP_OBJECT(object);
+    RmfModel *model = nullptr;
+    auto const node = rmf_map_object_peek_node(self, &model);
     switch ((enum Property)property_id) {
     case PROP_ORIGIN:
-        g_value_set_boxed(value, &self->origin);
+        if (model != nullptr) {
+            auto const record = rmf_model_entity(model, node->payload);
+            g_value_set_boxed(value, &record->origin);
+        }
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -46,38 +50,10 @@ static void rmf_entity_get_property(
     }
 }
 
-// RmfMapObject ////////////////////////////////////////////////////////////////
-
-static void rmf_entity_load(RmfMapObject *map_object, RmfLoader *loader)
-{
-    rmf_loader_log_begin(loader, "entity", nullptr);
-    RMF_MAP_OBJECT_CLASS(rmf_entity_parent_class)->load(map_object, loader);
-
-    auto const self = RMF_ENTITY(map_object);
-    auto object_type = rmf_map_object_get_object_type(RMF_MAP_OBJECT(self));
-    g_return_if_fail(object_type == RMF_OBJECT_TYPE_ENTITY);
-
-    rmf_loader_seek(loader, 2);
-    rmf_read_vector(loader, &self->origin);
-    rmf_loader_seek(loader, 4);
-
-    g_autofree auto content = g_strdup_printf(
-        "%g %g %g",
-        self->origin.x,
-        self->origin.y,
-        self->origin.z
-    );
-    rmf_loader_log_oneline(loader, "origin", content, nullptr);
-
-    rmf_loader_log_end(loader);
-}
-
 // RmfEntity ///////////////////////////////////////////////////////////////////
 
 static void rmf_entity_class_init(RmfEntityClass *klass)
 {
-    RMF_MAP_OBJECT_CLASS(klass)->load = rmf_entity_load;
-
     auto const oclass = G_OBJECT_CLASS(klass);
     oclass->get_property = rmf_entity_get_property;
 
@@ -108,20 +84,48 @@ static void rmf_entity_init(RmfEntity *)
  *
  * Gets the entity's origin point.
  *
- * Returns: The entity's origin.
+ * Returns: (transfer none) (nullable): The entity's origin.
  */
-RmfVector *rmf_entity_get_origin(RmfEntity *self)
+RmfVector const *rmf_entity_get_origin(RmfEntity *self)
 {
-    RmfVector *value = nullptr;
-    g_object_get(self, "origin", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ENTITY(self), nullptr);
+    RmfModel *model = nullptr;
+    auto const node = rmf_map_object_peek_node(RMF_MAP_OBJECT(self), &model);
+    return model ? &rmf_model_entity(model, node->payload)->origin : nullptr;
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-RmfEntity *rmf_entity_new(RmfLoader *loader)
+rmf_int rmf_entity_read(RmfLoader *loader)
+{
+    auto const model = loader->model;
+    auto const index = model->entities->len;
+    g_array_set_size(model->entities, index + 1);
+    auto const record = rmf_model_entity(model, index);
+
+    rmf_entity_data_read(loader, record);
+    rmf_loader_seek(loader, 2);
+    rmf_read_vector(loader, &record->origin);
+    rmf_loader_seek(loader, 4);
+
+    if (RMF_TRACE_ENABLED(loader)) {
+        // Only format the origin for sinks which use it.
+        g_autofree char *content = nullptr;
+        if (loader->trace_text) {
+            content = g_strdup_printf(
+                "%g %g %g",
+                record->origin.x,
+                record->origin.y,
+                record->origin.z
+            );
+        }
+        RMF_TRACE_ONELINE(loader, "origin", content, nullptr);
+    }
+    return index;
+}
+
+void rmf_entity_skip(RmfLoader *loader)
 {
-    RmfEntity *self = g_object_new(RMF_TYPE_ENTITY, nullptr);
-    rmf_entity_load(RMF_MAP_OBJECT(self), loader);
-    return self;
+    rmf_entity_data_skip(loader);
+    rmf_loader_seek(loader, 2 + sizeof(RmfVector) + 4);
 }
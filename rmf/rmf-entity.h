@@ -15,7 +15,7 @@ G_BEGIN_DECLS
 #define RMF_TYPE_ENTITY rmf_entity_get_type()
 G_DECLARE_FINAL_TYPE(RmfEntity, rmf_entity, RMF, ENTITY, RmfEntityData);
 
-RmfVector *rmf_entity_get_origin(RmfEntity *entity);
+RmfVector const *rmf_entity_get_origin(RmfEntity *entity);
 
 G_END_DECLS
 
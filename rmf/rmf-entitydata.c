@@ -36,12 +36,6 @@ RMF_DEFINE_ITERATOR_TYPE(
  *
  * Common data shared by [class@RmfEntity] and [class@RmfWorldspawn].
  */
-typedef struct {
-    rmf_nstring classname;
-    rmf_int spawnflags;
-    GPtrArray *keyvalues;
-} RmfEntityDataPrivate;
-
 enum Property {
     PROP_CLASSNAME = 1,
     PROP_SPAWNFLAGS,
@@ -52,21 +46,21 @@ enum Property {
 
 static GParamSpec *obj_properties[N_PROPERTIES];
 
-G_DEFINE_TYPE_WITH_PRIVATE(RmfEntityData, rmf_entity_data, RMF_TYPE_MAP_OBJECT)
+G_DEFINE_TYPE(RmfEntityData, rmf_entity_data, RMF_TYPE_MAP_OBJECT)
 
-// GObject /////////////////////////////////////////////////////////////////////
+// Private /////////////////////////////////////////////////////////////////////
 
-static void rmf_entity_data_dispose(GObject *object)
+static RmfEntityRecord const empty_record = {};
+
+static RmfEntityRecord const *get_record(RmfEntityData *self)
 {
-    auto self = RMF_ENTITY_DATA(object);
-    RmfEntityDataPrivate *priv = rmf_entity_data_get_instance_private(self);
-    if (priv->keyvalues) {
-        g_ptr_array_unref(priv->keyvalues);
-        priv->keyvalues = nullptr;
-    }
-    G_OBJECT_CLASS(rmf_entity_data_parent_class)->dispose(object);
+    RmfModel *model = nullptr;
+    auto const node = rmf_map_object_peek_node(RMF_MAP_OBJECT(self), &model);
+    return model ? rmf_model_entity(model, node->payload) : &empty_record;
 }
 
+// GObject /////////////////////////////////////////////////////////////////////
+
 static void rmf_entity_data_get_property(
     GObject *object,
     guint property_id,
@@ -75,20 +69,22 @@ static void rmf_entity_data_get_property(
 )
 {
     auto const self = RMF_ENTITY_DATA(object);
-    RmfEntityDataPrivate *const priv
-        = rmf_entity_data_get_instance_private(self);
+    auto const record = get_record(self);
     switch ((enum Property)property_id) {
     case PROP_CLASSNAME:
-        g_value_set_string(value, priv->classname.data);
+        g_value_set_string(value, record->classname);
         break;
     case PROP_SPAWNFLAGS:
-        g_value_set_uint(value, priv->spawnflags);
+        g_value_set_uint(value, record->spawnflags);
         break;
     case PROP_N_KEYVALUES:
-        g_value_set_uint(value, priv->keyvalues->len);
+        g_value_set_uint(value, record->keyvalues ? record->keyvalues->len : 0);
         break;
     case PROP_KEYVALUES:
-        g_value_take_object(value, rmf_keyvalue_iterator_new(priv->keyvalues));
+        g_value_take_object(
+            value,
+            rmf_keyvalue_iterator_new(record->keyvalues, self)
+        );
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -96,62 +92,11 @@ static void rmf_entity_data_get_property(
     }
 }
 
-// RmfMapObject ////////////////////////////////////////////////////////////////
-
-static void rmf_entity_data_load(RmfMapObject *map_object, RmfLoader *loader)
-{
-    auto self = RMF_ENTITY_DATA(map_object);
-    RmfEntityDataPrivate *priv = rmf_entity_data_get_instance_private(self);
-
-    RMF_MAP_OBJECT_CLASS(rmf_entity_data_parent_class)
-        ->load(map_object, loader);
-
-    rmf_read_nstring(loader, &priv->classname);
-    rmf_loader_seek(loader, 4);
-    rmf_read_int(loader, &priv->spawnflags);
-
-    rmf_loader_log_begin(
-        loader,
-        priv->classname.data,
-        "spawnflags",
-        "%u",
-        priv->spawnflags,
-        nullptr
-    );
-
-    rmf_int n_keyvalues;
-    rmf_read_int(loader, &n_keyvalues);
-
-    rmf_loader_log_begin(
-        loader,
-        "keyvalues",
-        "count",
-        "%u",
-        n_keyvalues,
-        nullptr
-    );
-
-    priv->keyvalues
-        = g_ptr_array_new_full(n_keyvalues, (GDestroyNotify)rmf_keyvalue_free);
-    for (rmf_int i = 0; i < n_keyvalues; ++i) {
-        RmfKeyvalue *keyvalue = rmf_keyvalue_new(loader);
-        g_ptr_array_add(priv->keyvalues, keyvalue);
-    }
-    rmf_loader_seek(loader, 12);
-
-    rmf_loader_log_end(loader);
-    rmf_loader_log_end(loader);
-}
-
 // RmfEntityData ///////////////////////////////////////////////////////////////
 
 static void rmf_entity_data_class_init(RmfEntityDataClass *klass)
 {
-    auto moclass = RMF_MAP_OBJECT_CLASS(klass);
-    moclass->load = rmf_entity_data_load;
-
     auto const oclass = G_OBJECT_CLASS(klass);
-    oclass->dispose = rmf_entity_data_dispose;
     oclass->get_property = rmf_entity_data_get_property;
 
     /**
@@ -221,13 +166,13 @@ static void rmf_entity_data_init(RmfEntityData *)
  *
  * Gets the entity's classname.
  *
- * Returns: The entity's classname.
+ * Returns: (transfer none) (nullable): The entity's classname, interned in the
+ * [struct@RmfStringPool] of the load.
  */
-char *rmf_entity_data_get_classname(RmfEntityData *self)
+char const *rmf_entity_data_get_classname(RmfEntityData *self)
 {
-    char *value = nullptr;
-    g_object_get(self, "classname", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ENTITY_DATA(self), nullptr);
+    return get_record(self)->classname;
 }
 
 /**
@@ -240,9 +185,8 @@ char *rmf_entity_data_get_classname(RmfEntityData *self)
  */
 rmf_int rmf_entity_data_get_spawnflags(RmfEntityData *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "spawnflags", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ENTITY_DATA(self), 0);
+    return get_record(self)->spawnflags;
 }
 
 /**
@@ -255,9 +199,9 @@ rmf_int rmf_entity_data_get_spawnflags(RmfEntityData *self)
  */
 rmf_int rmf_entity_data_get_n_keyvalues(RmfEntityData *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "n-keyvalues", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ENTITY_DATA(self), 0);
+    auto const keyvalues = get_record(self)->keyvalues;
+    return keyvalues ? keyvalues->len : 0;
 }
 
 /**
@@ -270,16 +214,71 @@ rmf_int rmf_entity_data_get_n_keyvalues(RmfEntityData *self)
  */
 RmfKeyvalueIterator *rmf_entity_data_get_keyvalues(RmfEntityData *self)
 {
-    RmfKeyvalueIterator *value = nullptr;
-    g_object_get(self, "keyvalues", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ENTITY_DATA(self), nullptr);
+    return rmf_keyvalue_iterator_new(get_record(self)->keyvalues, self);
+}
+
+/**
+ * rmf_entity_data_get_keyvalue_array:
+ * @entity_data: The entity.
+ * @n_keyvalues: (out): Return location for the number of keyvalues.
+ *
+ * Gets the key-values associated with the object as an array, without making
+ * an iterator.
+ *
+ * Returns: (transfer none) (array length=n_keyvalues) (nullable): The
+ * key-values, valid as long as the object.
+ */
+RmfKeyvalue *const *
+rmf_entity_data_get_keyvalue_array(RmfEntityData *self, guint *n_keyvalues)
+{
+    g_return_val_if_fail(RMF_IS_ENTITY_DATA(self), nullptr);
+    g_return_val_if_fail(n_keyvalues != nullptr, nullptr);
+    auto const keyvalues = get_record(self)->keyvalues;
+    return (RmfKeyvalue *const *)rmf_ptr_array_span(keyvalues, n_keyvalues);
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-RmfEntityData *rmf_entity_data_new(RmfLoader *loader)
+// Read the part shared by entities and worldspawns into @record.
+void rmf_entity_data_read(RmfLoader *loader, RmfEntityRecord *record)
+{
+    record->classname = rmf_read_interned_nstring(loader);
+    rmf_loader_seek(loader, 4);
+    rmf_read_int(loader, &record->spawnflags);
+
+    RMF_TRACE_BEGIN(
+        loader,
+        record->classname,
+        "spawnflags=\"%u\"",
+        record->spawnflags
+    );
+
+    rmf_int n_keyvalues;
+    rmf_read_count(loader, &n_keyvalues, 4);
+
+    RMF_TRACE_BEGIN(loader, "keyvalues", "count=\"%u\"", n_keyvalues);
+
+    // Keyvalues are allocated from the load's arena.
+    record->keyvalues = g_ptr_array_new_full(n_keyvalues, nullptr);
+    for (rmf_int i = 0; i < n_keyvalues; ++i) {
+        RmfKeyvalue *keyvalue = rmf_keyvalue_new(loader);
+        g_ptr_array_add(record->keyvalues, keyvalue);
+    }
+    rmf_loader_seek(loader, 12);
+
+    RMF_TRACE_END(loader);
+    RMF_TRACE_END(loader);
+}
+
+void rmf_entity_data_skip(RmfLoader *loader)
 {
-    RmfEntityData *self = g_object_new(RMF_TYPE_ENTITY_DATA, nullptr);
-    rmf_entity_data_load(RMF_MAP_OBJECT(self), loader);
-    return self;
+    rmf_skip_nstring(loader);
+    rmf_loader_seek(loader, 4 + sizeof(rmf_int));
+    rmf_int n_keyvalues = 0;
+    rmf_read_count(loader, &n_keyvalues, 4);
+    for (rmf_int i = 0; i < n_keyvalues && !rmf_loader_failed(loader); ++i) {
+        rmf_skip_keyvalue(loader);
+    }
+    rmf_loader_seek(loader, 12);
 }
@@ -41,10 +41,14 @@ struct _RmfEntityDataClass {
     RmfMapObjectClass parent_class;
 };
 
-char *rmf_entity_data_get_classname(RmfEntityData *entity_data);
+char const *rmf_entity_data_get_classname(RmfEntityData *entity_data);
 rmf_int rmf_entity_data_get_spawnflags(RmfEntityData *entity_data);
 rmf_int rmf_entity_data_get_n_keyvalues(RmfEntityData *entity_data);
 RmfKeyvalueIterator *rmf_entity_data_get_keyvalues(RmfEntityData *entity_data);
+RmfKeyvalue *const *rmf_entity_data_get_keyvalue_array(
+    RmfEntityData *entity_data,
+    guint *n_keyvalues
+);
 
 G_END_DECLS
 
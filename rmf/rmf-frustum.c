@@ -0,0 +1,230 @@
+#include "rmf/rmf-frustum.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+#include <math.h>
+
+/**
+ * RMF_FRUSTUM_N_PLANES:
+ *
+ * Number of planes of an [struct@RmfFrustum], padded up from six to fill two
+ * 4-wide vectors.
+ */
+
+/**
+ * RmfFrustum:
+ * @nx: X components of the plane normals.
+ * @ny: Y components of the plane normals.
+ * @nz: Z components of the plane normals.
+ * @d: Distances of the planes along their normals.
+ *
+ * A convex volume bounded by planes, such as what a camera sees. Plane i holds
+ * the points p with nx[i] * p.x + ny[i] * p.y + nz[i] * p.z = d[i], and its
+ * normal points out of the volume. Unused planes have a zero normal and a
+ * positive distance, so they hold back nothing.
+ *
+ * Set one up for a camera with `rmf_frustum_init_for_camera()`, or fill in the
+ * planes directly.
+ */
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Set plane @i to face along @normal and pass through @point.
+static void set_plane(
+    RmfFrustum *frustum,
+    guint i,
+    RmfVector normal,
+    RmfVector const *point
+)
+{
+    frustum->nx[i] = normal.x;
+    frustum->ny[i] = normal.y;
+    frustum->nz[i] = normal.z;
+    frustum->d[i]
+        = normal.x * point->x + normal.y * point->y + normal.z * point->z;
+}
+
+static RmfVector normalize(RmfVector v)
+{
+    auto const length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+    return length > 0.0f
+             ? (RmfVector){v.x / length, v.y / length, v.z / length}
+             : v;
+}
+
+static RmfVector cross(RmfVector a, RmfVector b)
+{
+    return (RmfVector){
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x,
+    };
+}
+
+// Get @a minus @b scaled by @s.
+static RmfVector sub_scaled(RmfVector a, RmfVector b, rmf_float s)
+{
+    return (RmfVector){a.x - b.x * s, a.y - b.y * s, a.z - b.z * s};
+}
+
+typedef enum {
+    OUTSIDE,
+    CROSSING,
+    INSIDE,
+} Overlap;
+
+// Test a box against every plane at once. For each plane, the corner of the
+// box furthest along the normal decides whether any of it is inside, and the
+// nearest corner whether all of it is. The loop has no branches, so it is
+// vectorised across the planes.
+static Overlap box_overlap(RmfFrustum const *frustum, RmfBounds const *box)
+{
+    bool outside = false;
+    bool crossing = false;
+    for (guint i = 0; i < RMF_FRUSTUM_N_PLANES; ++i) {
+        auto const nx = frustum->nx[i];
+        auto const ny = frustum->ny[i];
+        auto const nz = frustum->nz[i];
+        auto const lowest = (nx > 0.0f ? box->min.x : box->max.x) * nx
+                        + (ny > 0.0f ? box->min.y : box->max.y) * ny
+                        + (nz > 0.0f ? box->min.z : box->max.z) * nz;
+        auto const highest = (nx > 0.0f ? box->max.x : box->min.x) * nx
+                       + (ny > 0.0f ? box->max.y : box->min.y) * ny
+                       + (nz > 0.0f ? box->max.z : box->min.z) * nz;
+        outside |= lowest > frustum->d[i];
+        crossing |= highest > frustum->d[i];
+    }
+    return outside ? OUTSIDE : crossing ? CROSSING : INSIDE;
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_frustum_init_for_camera:
+ * @frustum: (out caller-allocates): The frustum to set up.
+ * @camera: The camera, eg. one of the cameras of the map's
+ *   [struct@RmfDocinfo].
+ * @fov: Vertical field of view, in degrees, between 0 and 180.
+ * @aspect: Width of the view divided by its height. Must be positive.
+ * @distance: Distance from the eye to the far plane. Must be positive.
+ *
+ * Sets up the frustum a camera sees, from its eye out to @distance. The camera
+ * is kept upright, with Z pointing up, unless it looks straight up or down.
+ * Its eye and look-at positions must differ.
+ */
+void rmf_frustum_init_for_camera(
+    RmfFrustum *frustum,
+    RmfCamera const *camera,
+    rmf_float fov,
+    rmf_float aspect,
+    rmf_float distance
+)
+{
+    g_return_if_fail(frustum != nullptr);
+    g_return_if_fail(camera != nullptr);
+    g_return_if_fail(fov > 0.0f && fov < 180.0f);
+    g_return_if_fail(aspect > 0.0f);
+    g_return_if_fail(distance > 0.0f);
+
+    auto const eye = &camera->eye_position;
+    auto const view = sub_scaled(camera->lookat_position, *eye, 1.0f);
+    g_return_if_fail(view.x != 0.0f || view.y != 0.0f || view.z != 0.0f);
+    auto const forward = normalize(view);
+    RmfVector up = {0.0f, 0.0f, 1.0f};
+    if (fabsf(forward.z) > 0.999f) {
+        up = (RmfVector){0.0f, 1.0f, 0.0f};
+    }
+    auto const right = normalize(cross(forward, up));
+    up = cross(right, forward);
+
+    auto const tan_y = tanf(fov * (float)G_PI / 360.0f);
+    auto const tan_x = tan_y * aspect;
+    RmfVector const back = {-forward.x, -forward.y, -forward.z};
+    RmfVector const left = {-right.x, -right.y, -right.z};
+    RmfVector const down = {-up.x, -up.y, -up.z};
+    auto const far_point = sub_scaled(*eye, forward, -distance);
+
+    set_plane(frustum, 0, back, eye);
+    set_plane(frustum, 1, forward, &far_point);
+    set_plane(frustum, 2, sub_scaled(right, forward, tan_x), eye);
+    set_plane(frustum, 3, sub_scaled(left, forward, tan_x), eye);
+    set_plane(frustum, 4, sub_scaled(up, forward, tan_y), eye);
+    set_plane(frustum, 5, sub_scaled(down, forward, tan_y), eye);
+    for (guint i = 6; i < RMF_FRUSTUM_N_PLANES; ++i) {
+        frustum->nx[i] = frustum->ny[i] = frustum->nz[i] = 0.0f;
+        frustum->d[i] = 1.0f;
+    }
+}
+
+/**
+ * rmf_bvh_query_frustum:
+ * @bvh: The hierarchy.
+ * @frustum: The volume to look in.
+ * @results: (element-type guint32): Array to append the node indices of the
+ *   objects touching @frustum to.
+ *
+ * Finds the objects whose bounds may overlap a frustum. Boxes are only tested
+ * against each plane in turn, so a few boxes just outside near the corners of
+ * the frustum are found as well. Subtrees wholly inside the frustum are taken
+ * without testing their objects.
+ *
+ * Brush entities are found as described for [struct@RmfBvh].
+ *
+ * Returns: The number of objects found.
+ */
+guint rmf_bvh_query_frustum(
+    RmfBvh *self,
+    RmfFrustum const *frustum,
+    GArray *results
+)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_return_val_if_fail(frustum != nullptr, 0);
+    g_return_val_if_fail(results != nullptr, 0);
+    if (self->n_nodes == 0) {
+        return 0;
+    }
+
+    // Stack entries carry whether their node is known to be wholly inside.
+    constexpr rmf_int INSIDE_BIT = 1u << 31;
+    rmf_int stack_buf[64];
+    g_autofree rmf_int *stack_heap = nullptr;
+    auto stack = stack_buf;
+    if (self->depth >= G_N_ELEMENTS(stack_buf)) {
+        stack = stack_heap = g_new(rmf_int, self->depth + 1);
+    }
+
+    auto const len = results->len;
+    guint top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        auto const entry = stack[--top];
+        auto const index = entry & ~INSIDE_BIT;
+        auto const node = &self->nodes[index];
+        auto overlap = INSIDE;
+        if (!(entry & INSIDE_BIT)) {
+            overlap = box_overlap(frustum, &node->bounds);
+        }
+        if (overlap == OUTSIDE) {
+            continue;
+        }
+
+        if (node->count == 0) {
+            auto const flag = overlap == INSIDE ? INSIDE_BIT : 0;
+            stack[top++] = node->first | flag;
+            stack[top++] = (index + 1) | flag;
+            continue;
+        }
+        for (rmf_int i = node->first; i < node->first + node->count; ++i) {
+            if (overlap == INSIDE
+                || box_overlap(frustum, &self->bounds[i]) != OUTSIDE)
+            {
+                g_array_append_val(results, self->objects[i]);
+            }
+        }
+    }
+    rmf_bvh_add_brush_entities(self, results, len);
+    return results->len - len;
+}
@@ -0,0 +1,42 @@
+#ifndef RMF_FRUSTUM_H
+#define RMF_FRUSTUM_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-bvh.h"
+#include "rmf/rmf-structs.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfFrustum
+
+#define RMF_FRUSTUM_N_PLANES 8
+
+typedef struct {
+    rmf_float nx[RMF_FRUSTUM_N_PLANES];
+    rmf_float ny[RMF_FRUSTUM_N_PLANES];
+    rmf_float nz[RMF_FRUSTUM_N_PLANES];
+    rmf_float d[RMF_FRUSTUM_N_PLANES];
+} RmfFrustum;
+
+void rmf_frustum_init_for_camera(
+    RmfFrustum *frustum,
+    RmfCamera const *camera,
+    rmf_float fov,
+    rmf_float aspect,
+    rmf_float distance
+);
+guint rmf_bvh_query_frustum(
+    RmfBvh *bvh,
+    RmfFrustum const *frustum,
+    GArray *results
+);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,173 @@
+#include "rmf/rmf-geometry.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfRange:
+ * @first: Index of the first item.
+ * @count: Number of items.
+ *
+ * A run of consecutive items in one of the arrays of an [struct@RmfGeometry].
+ */
+
+/**
+ * RmfGeometry:
+ *
+ * The vertices of all faces of a map, packed into one array.
+ *
+ * Passes over the whole map's geometry scan through the store in order instead
+ * of visiting every solid and face. Faces are listed solid by solid, and solids
+ * in the order of the file, which is also the order of their nodes' payload
+ * indices in the [struct@RmfModel]. The [struct@RmfFace]s of the map point
+ * into the store, which lives as long as any of them.
+ *
+ * Load with [flags@RmfLoaderFlags.GEOMETRY_STORE] to build one, and get it with
+ * [method@RmfRoot.get_geometry].
+ */
+struct _RmfGeometry {
+    RmfVector *vertices;
+    RmfRange *faces;  // Ranges of vertices.
+    RmfRange *solids; // Ranges of faces.
+    guint n_vertices;
+    guint n_faces;
+    guint n_solids;
+};
+
+G_DEFINE_BOXED_TYPE(
+    RmfGeometry,
+    rmf_geometry,
+    rmf_geometry_ref,
+    rmf_geometry_unref
+)
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static void geometry_clear(RmfGeometry *self)
+{
+    g_free(self->vertices);
+    g_free(self->faces);
+    g_free(self->solids);
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_geometry_ref:
+ * @geometry: The geometry.
+ *
+ * Increases the reference count of a geometry store.
+ *
+ * Returns: (transfer full): The geometry.
+ */
+RmfGeometry *rmf_geometry_ref(RmfGeometry *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_geometry_unref:
+ * @geometry: (transfer full): The geometry.
+ *
+ * Decreases the reference count of a geometry store, freeing it when it
+ * reaches zero.
+ */
+void rmf_geometry_unref(RmfGeometry *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)geometry_clear);
+}
+
+/**
+ * rmf_geometry_get_vertices:
+ * @geometry: The geometry.
+ * @n_vertices: (out): Return location for the number of vertices.
+ *
+ * Gets the vertices of all faces, face after face.
+ *
+ * Returns: (transfer none) (array length=n_vertices): The vertices.
+ */
+RmfVector const *rmf_geometry_get_vertices(RmfGeometry *self, guint *n_vertices)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_vertices != nullptr, nullptr);
+    *n_vertices = self->n_vertices;
+    return self->vertices;
+}
+
+/**
+ * rmf_geometry_get_faces:
+ * @geometry: The geometry.
+ * @n_faces: (out): Return location for the number of faces.
+ *
+ * Gets the range of vertices of each face.
+ *
+ * Returns: (transfer none) (array length=n_faces): The faces.
+ */
+RmfRange const *rmf_geometry_get_faces(RmfGeometry *self, guint *n_faces)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_faces != nullptr, nullptr);
+    *n_faces = self->n_faces;
+    return self->faces;
+}
+
+/**
+ * rmf_geometry_get_solids:
+ * @geometry: The geometry.
+ * @n_solids: (out): Return location for the number of solids.
+ *
+ * Gets the range of faces of each solid.
+ *
+ * Returns: (transfer none) (array length=n_solids): The solids.
+ */
+RmfRange const *rmf_geometry_get_solids(RmfGeometry *self, guint *n_solids)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_solids != nullptr, nullptr);
+    *n_solids = self->n_solids;
+    return self->solids;
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Move the vertices of every face in @model into a new store, pointing the
+// faces at their new home. The old copies are left to their arena. Solids
+// are listed in file order, as in the model.
+RmfGeometry *rmf_geometry_new_for_model(RmfModel *model)
+{
+    RmfGeometry *self = g_atomic_rc_box_new0(RmfGeometry);
+    self->n_solids = model->solids->len;
+    for (guint i = 0; i < self->n_solids; ++i) {
+        GPtrArray *faces = rmf_model_solid(model, i)->faces;
+        for (guint j = 0; faces != nullptr && j < faces->len; ++j) {
+            RmfFace const *face = faces->pdata[j];
+            self->n_vertices += face->n_vertices;
+        }
+        self->n_faces += faces ? faces->len : 0;
+    }
+    self->vertices = g_new(RmfVector, self->n_vertices);
+    self->faces = g_new(RmfRange, self->n_faces);
+    self->solids = g_new(RmfRange, self->n_solids);
+
+    guint n_faces = 0;
+    guint n_vertices = 0;
+    for (guint i = 0; i < self->n_solids; ++i) {
+        GPtrArray *faces = rmf_model_solid(model, i)->faces;
+        auto const n_solid_faces = faces ? faces->len : 0;
+        self->solids[i] = (RmfRange){n_faces, n_solid_faces};
+        for (guint j = 0; j < n_solid_faces; ++j) {
+            RmfFace *face = faces->pdata[j];
+            auto const vertices = self->vertices + n_vertices;
+            auto const size = face->n_vertices * sizeof(RmfVector);
+            memcpy(vertices, face->vertices, size);
+            face->vertices = vertices;
+            self->faces[n_faces++] = (RmfRange){n_vertices, face->n_vertices};
+            n_vertices += face->n_vertices;
+        }
+    }
+    return self;
+}
@@ -0,0 +1,40 @@
+#ifndef RMF_GEOMETRY_H
+#define RMF_GEOMETRY_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfRange
+
+typedef struct {
+    rmf_int first;
+    rmf_int count;
+} RmfRange;
+
+// RmfGeometry
+
+#define RMF_TYPE_GEOMETRY rmf_geometry_get_type()
+
+typedef struct _RmfGeometry RmfGeometry;
+
+GType rmf_geometry_get_type(void);
+RmfGeometry *rmf_geometry_ref(RmfGeometry *geometry);
+void rmf_geometry_unref(RmfGeometry *geometry);
+RmfVector const *
+rmf_geometry_get_vertices(RmfGeometry *geometry, guint *n_vertices);
+RmfRange const *rmf_geometry_get_faces(RmfGeometry *geometry, guint *n_faces);
+RmfRange const *
+rmf_geometry_get_solids(RmfGeometry *geometry, guint *n_solids);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfGeometry, rmf_geometry_unref)
+
+G_END_DECLS
+
+#endif
@@ -29,12 +29,15 @@ void *rmf_iterator_next(RmfIterator *iterator);
  *
  * Helper macro for iterating through [iface@RmfIterator]s.
  *
+ * Each iterator is an object of its own. Hot loops can walk the items in place
+ * instead, with getters such as [method@RmfSolid.get_face_array].
+ *
  * Example usage:
  *
  * ```c
  * RmfKeyvalueIterator *keyvalues = ...;
  * RMF_ITERATOR_FOREACH(RmfKeyvalue, kv, keyvalues) {
- *   g_print("key:%s value:%s\n", kv->key.data, kv->value.data);
+ *   g_print("key:%s value:%s\n", kv->key, kv->value);
  * }
  * ```
  */
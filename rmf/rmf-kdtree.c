@@ -0,0 +1,507 @@
+#include "rmf/rmf-kdtree.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * RmfKdTree:
+ *
+ * A k-d tree over the origins of the entities of an [struct@RmfModel], for
+ * finding the entities nearest to a point or within a distance of it without
+ * scanning them all.
+ *
+ * The tree is balanced and implicit: each range of entities is split at its
+ * median along its widest axis, and the median stays in the middle of the
+ * range, so the tree is just the reordered entities and a split axis for each.
+ * Queries return node indices into the model, which
+ * [method@RmfModel.get_object] makes objects of.
+ */
+typedef struct {
+    RmfVector point;
+    rmf_int node;
+} RmfKdItem;
+
+struct _RmfKdTree {
+    RmfModel *model;
+    RmfKdItem *items;
+    guint8 *axes; // Split axis of the range each item is the median of.
+    rmf_int n_items;
+};
+
+G_DEFINE_BOXED_TYPE(RmfKdTree, rmf_kd_tree, rmf_kd_tree_ref, rmf_kd_tree_unref)
+
+// Queries per chunk of a batch.
+#define QUERY_GRAIN 64
+
+// Results kept on the stack by a query before it allocates.
+#define N_STACK_RESULTS 64
+
+typedef struct {
+    RmfKdTree *tree;
+    RmfVector const *points;
+    guint k;
+    rmf_int *results;
+    rmf_float *distances;
+    guint *counts;
+} Batch;
+
+// The k nearest items found so far, as a max-heap on distance.
+typedef struct {
+    rmf_int *nodes;
+    rmf_float *distances; // Squared.
+    guint k;
+    guint n;
+} Heap;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static rmf_float axis_of(RmfVector const *v, guint axis)
+{
+    return axis == 0 ? v->x : axis == 1 ? v->y : v->z;
+}
+
+static rmf_float distance2(RmfVector const *a, RmfVector const *b)
+{
+    auto const dx = a->x - b->x;
+    auto const dy = a->y - b->y;
+    auto const dz = a->z - b->z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static void swap_items(RmfKdItem *items, rmf_int i, rmf_int j)
+{
+    auto const item = items[i];
+    items[i] = items[j];
+    items[j] = item;
+}
+
+// Reorder @items[@begin, @end) so that item @nth is the one that would be
+// there if they were sorted along @axis, with none after it lower and none
+// before it higher.
+static void select_nth(
+    RmfKdItem *items,
+    rmf_int begin,
+    rmf_int end,
+    rmf_int nth,
+    guint axis
+)
+{
+    while (end - begin > 1) {
+        auto const middle = &items[begin + (end - begin) / 2];
+        auto const pivot = axis_of(&middle->point, axis);
+        // Signed, as j may step to just before @begin.
+        gint64 i = begin;
+        gint64 j = (gint64)end - 1;
+        while (i <= j) {
+            while (axis_of(&items[i].point, axis) < pivot) {
+                i++;
+            }
+            while (axis_of(&items[j].point, axis) > pivot) {
+                j--;
+            }
+            if (i <= j) {
+                swap_items(items, i++, j--);
+            }
+        }
+        // Now [begin, j] <= pivot <= [i, end), and anything in between is
+        // equal to the pivot.
+        if ((gint64)nth <= j) {
+            end = j + 1;
+        } else if ((gint64)nth >= i) {
+            begin = i;
+        } else {
+            return;
+        }
+    }
+}
+
+static void build(RmfKdTree *self, rmf_int begin, rmf_int end)
+{
+    while (begin < end) {
+        RmfBounds bounds;
+        rmf_bounds_clear(&bounds);
+        for (rmf_int i = begin; i < end; ++i) {
+            auto const p = self->items[i].point;
+            rmf_bounds_union(&bounds, &(RmfBounds){p, p});
+        }
+        auto const dx = bounds.max.x - bounds.min.x;
+        auto const dy = bounds.max.y - bounds.min.y;
+        auto const dz = bounds.max.z - bounds.min.z;
+        guint const axis = dx >= dy && dx >= dz ? 0 : dy >= dz ? 1 : 2;
+
+        auto const mid = begin + (end - begin) / 2;
+        select_nth(self->items, begin, end, mid, axis);
+        self->axes[mid] = axis;
+
+        build(self, begin, mid);
+        begin = mid + 1;
+    }
+}
+
+static void heap_push(Heap *heap, rmf_int node, rmf_float d2)
+{
+    guint i;
+    if (heap->n < heap->k) {
+        // Sift the new item up from the bottom.
+        i = heap->n++;
+        while (i > 0 && heap->distances[(i - 1) / 2] < d2) {
+            heap->nodes[i] = heap->nodes[(i - 1) / 2];
+            heap->distances[i] = heap->distances[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+    } else {
+        // Replace the furthest item and sift down from the top.
+        i = 0;
+        for (;;) {
+            auto child = 2 * i + 1;
+            if (child >= heap->n) {
+                break;
+            }
+            if (child + 1 < heap->n
+                && heap->distances[child + 1] > heap->distances[child])
+            {
+                child++;
+            }
+            if (heap->distances[child] <= d2) {
+                break;
+            }
+            heap->nodes[i] = heap->nodes[child];
+            heap->distances[i] = heap->distances[child];
+            i = child;
+        }
+    }
+    heap->nodes[i] = node;
+    heap->distances[i] = d2;
+}
+
+// Sort the heap nearest first, in place.
+static void heap_sort(Heap *heap)
+{
+    for (auto n = heap->n; n > 1; --n) {
+        auto const node = heap->nodes[n - 1];
+        auto const d2 = heap->distances[n - 1];
+        heap->nodes[n - 1] = heap->nodes[0];
+        heap->distances[n - 1] = heap->distances[0];
+
+        // Sift the last item down from the top of the shrunken heap.
+        Heap rest = {heap->nodes, heap->distances, n - 1, n - 1};
+        heap_push(&rest, node, d2);
+    }
+}
+
+static void find_nearest(
+    RmfKdTree const *self,
+    rmf_int begin,
+    rmf_int end,
+    RmfVector const *point,
+    Heap *heap
+)
+{
+    while (begin < end) {
+        auto const mid = begin + (end - begin) / 2;
+        auto const item = &self->items[mid];
+        auto const d2 = distance2(&item->point, point);
+        if (heap->n < heap->k || d2 < heap->distances[0]) {
+            heap_push(heap, item->node, d2);
+        }
+
+        auto const axis = self->axes[mid];
+        auto const offset = axis_of(point, axis) - axis_of(&item->point, axis);
+        bool const left_first = offset < 0.0f;
+
+        // Search the side of the split holding the point first, and the
+        // other side only if it could hold anything nearer.
+        if (left_first) {
+            find_nearest(self, begin, mid, point, heap);
+        } else {
+            find_nearest(self, mid + 1, end, point, heap);
+        }
+        if (heap->n == heap->k && offset * offset >= heap->distances[0]) {
+            return;
+        }
+        if (left_first) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+}
+
+static void find_within(
+    RmfKdTree const *self,
+    rmf_int begin,
+    rmf_int end,
+    RmfVector const *point,
+    rmf_float radius2,
+    GArray *results
+)
+{
+    while (begin < end) {
+        auto const mid = begin + (end - begin) / 2;
+        auto const item = &self->items[mid];
+        if (distance2(&item->point, point) <= radius2) {
+            g_array_append_val(results, item->node);
+        }
+
+        auto const axis = self->axes[mid];
+        auto const offset = axis_of(point, axis) - axis_of(&item->point, axis);
+        if (offset * offset > radius2) {
+            // Only the side of the split holding the point is in reach.
+            if (offset < 0.0f) {
+                end = mid;
+            } else {
+                begin = mid + 1;
+            }
+            continue;
+        }
+        find_within(self, begin, mid, point, radius2, results);
+        begin = mid + 1;
+    }
+}
+
+static guint nearest(
+    RmfKdTree *self,
+    RmfVector const *point,
+    guint k,
+    rmf_int *results,
+    rmf_float *distances
+)
+{
+    rmf_float stack_distances[N_STACK_RESULTS];
+    g_autofree rmf_float *heap_distances = nullptr;
+    if (distances == nullptr) {
+        distances = stack_distances;
+        if (k > N_STACK_RESULTS) {
+            distances = heap_distances = g_new(rmf_float, k);
+        }
+    }
+
+    Heap heap = {.nodes = results, .distances = distances, .k = k};
+    if (k > 0) {
+        find_nearest(self, 0, self->n_items, point, &heap);
+    }
+    heap_sort(&heap);
+    for (guint i = 0; i < heap.n; ++i) {
+        distances[i] = sqrtf(distances[i]);
+    }
+    return heap.n;
+}
+
+static void nearest_batch(guint begin, guint end, guint, gpointer user_data)
+{
+    Batch const *batch = user_data;
+    for (guint i = begin; i < end; ++i) {
+        auto const n = nearest(
+            batch->tree,
+            &batch->points[i],
+            batch->k,
+            batch->results + (gsize)i * batch->k,
+            batch->distances ? batch->distances + (gsize)i * batch->k : nullptr
+        );
+        if (batch->counts != nullptr) {
+            batch->counts[i] = n;
+        }
+    }
+}
+
+static void kd_tree_clear(RmfKdTree *self)
+{
+    g_free(self->items);
+    g_free(self->axes);
+    rmf_model_unref(self->model);
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_kd_tree_new:
+ * @model: The model to index.
+ * @classname: (nullable): Only index entities of this class.
+ *
+ * Builds a k-d tree over the origins of the entities of a model, leaving out
+ * the worldspawn.
+ *
+ * Returns: (transfer full): The new tree.
+ */
+RmfKdTree *rmf_kd_tree_new(RmfModel *model, char const *classname)
+{
+    g_return_val_if_fail(model != nullptr, nullptr);
+
+    RmfKdTree *self = g_atomic_rc_box_new0(RmfKdTree);
+    self->model = rmf_model_ref(model);
+    self->items = g_new(RmfKdItem, model->entities->len);
+    for (rmf_int i = 0; i < model->nodes->len; ++i) {
+        auto const node = rmf_model_node(model, i);
+        if (node->object_type != RMF_OBJECT_TYPE_ENTITY) {
+            continue;
+        }
+        auto const entity = rmf_model_entity(model, node->payload);
+        if (classname != nullptr
+            && g_strcmp0(entity->classname, classname) != 0)
+        {
+            continue;
+        }
+        self->items[self->n_items++] = (RmfKdItem){entity->origin, i};
+    }
+    self->axes = g_new0(guint8, self->n_items);
+    build(self, 0, self->n_items);
+    return self;
+}
+
+/**
+ * rmf_kd_tree_ref:
+ * @tree: The tree.
+ *
+ * Increases the reference count of a k-d tree.
+ *
+ * Returns: (transfer full): The tree.
+ */
+RmfKdTree *rmf_kd_tree_ref(RmfKdTree *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_kd_tree_unref:
+ * @tree: (transfer full): The tree.
+ *
+ * Decreases the reference count of a k-d tree, freeing it when it reaches
+ * zero.
+ */
+void rmf_kd_tree_unref(RmfKdTree *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)kd_tree_clear);
+}
+
+/**
+ * rmf_kd_tree_get_model:
+ * @tree: The tree.
+ *
+ * Gets the model the tree indexes.
+ *
+ * Returns: (transfer none): The model.
+ */
+RmfModel *rmf_kd_tree_get_model(RmfKdTree *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return self->model;
+}
+
+/**
+ * rmf_kd_tree_get_n_entities:
+ * @tree: The tree.
+ *
+ * Gets the number of entities in the tree.
+ *
+ * Returns: The number of entities.
+ */
+guint rmf_kd_tree_get_n_entities(RmfKdTree *self)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    return self->n_items;
+}
+
+/**
+ * rmf_kd_tree_find_nearest:
+ * @tree: The tree.
+ * @point: The point to search around.
+ * @k: Most entities to find.
+ * @results: (array length=k) (out caller-allocates): Return location for the
+ *   node indices of the entities found, nearest first.
+ * @distances: (array length=k) (out caller-allocates) (nullable): Return
+ *   location for the distances of the entities found.
+ *
+ * Finds the @k entities nearest to a point, or all of them if there are
+ * fewer.
+ *
+ * Returns: The number of entities found.
+ */
+guint rmf_kd_tree_find_nearest(
+    RmfKdTree *self,
+    RmfVector const *point,
+    guint k,
+    rmf_int *results,
+    rmf_float *distances
+)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_return_val_if_fail(point != nullptr, 0);
+    g_return_val_if_fail(results != nullptr || k == 0, 0);
+    return nearest(self, point, k, results, distances);
+}
+
+/**
+ * rmf_kd_tree_find_nearest_batch:
+ * @tree: The tree.
+ * @points: (array length=n_points): The points to search around.
+ * @n_points: Number of points.
+ * @k: Most entities to find around each point.
+ * @results: (out caller-allocates): Return location for @k node indices for
+ *   each point, like [method@RmfKdTree.find_nearest].
+ * @distances: (out caller-allocates) (nullable): Return location for @k
+ *   distances for each point.
+ * @counts: (array length=n_points) (out caller-allocates) (nullable): Return
+ *   location for the number of entities found around each point.
+ *
+ * Finds the @k entities nearest to each of many points, spread over a shared
+ * thread pool and the calling thread. The results for point i start at
+ * @results[i * @k].
+ */
+void rmf_kd_tree_find_nearest_batch(
+    RmfKdTree *self,
+    RmfVector const *points,
+    guint n_points,
+    guint k,
+    rmf_int *results,
+    rmf_float *distances,
+    guint *counts
+)
+{
+    g_return_if_fail(self != nullptr);
+    g_return_if_fail(points != nullptr || n_points == 0);
+    g_return_if_fail(results != nullptr || n_points == 0 || k == 0);
+
+    Batch batch = {
+        .tree = self,
+        .points = points,
+        .k = k,
+        .results = results,
+        .distances = distances,
+        .counts = counts,
+    };
+    rmf_parallel_for(n_points, QUERY_GRAIN, nearest_batch, &batch);
+}
+
+/**
+ * rmf_kd_tree_find_within:
+ * @tree: The tree.
+ * @point: The point to search around.
+ * @radius: How far from @point to search. Must not be negative.
+ * @results: (element-type guint32): Array to append the node indices of the
+ *   entities found to.
+ *
+ * Finds the entities within a distance of a point, in no particular order.
+ *
+ * Returns: The number of entities found.
+ */
+guint rmf_kd_tree_find_within(
+    RmfKdTree *self,
+    RmfVector const *point,
+    rmf_float radius,
+    GArray *results
+)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_return_val_if_fail(point != nullptr, 0);
+    g_return_val_if_fail(results != nullptr, 0);
+    g_return_val_if_fail(radius >= 0.0f, 0);
+    auto const len = results->len;
+    find_within(self, 0, self->n_items, point, radius * radius, results);
+    return results->len - len;
+}
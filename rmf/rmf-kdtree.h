@@ -0,0 +1,54 @@
+#ifndef RMF_KDTREE_H
+#define RMF_KDTREE_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-model.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfKdTree
+
+#define RMF_TYPE_KD_TREE rmf_kd_tree_get_type()
+
+typedef struct _RmfKdTree RmfKdTree;
+
+GType rmf_kd_tree_get_type(void);
+RmfKdTree *rmf_kd_tree_new(RmfModel *model, char const *classname);
+RmfKdTree *rmf_kd_tree_ref(RmfKdTree *tree);
+void rmf_kd_tree_unref(RmfKdTree *tree);
+RmfModel *rmf_kd_tree_get_model(RmfKdTree *tree);
+guint rmf_kd_tree_get_n_entities(RmfKdTree *tree);
+guint rmf_kd_tree_find_nearest(
+    RmfKdTree *tree,
+    RmfVector const *point,
+    guint k,
+    rmf_int *results,
+    rmf_float *distances
+);
+void rmf_kd_tree_find_nearest_batch(
+    RmfKdTree *tree,
+    RmfVector const *points,
+    guint n_points,
+    guint k,
+    rmf_int *results,
+    rmf_float *distances,
+    guint *counts
+);
+guint rmf_kd_tree_find_within(
+    RmfKdTree *tree,
+    RmfVector const *point,
+    rmf_float radius,
+    GArray *results
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfKdTree, rmf_kd_tree_unref)
+
+G_END_DECLS
+
+#endif
@@ -7,22 +7,72 @@
 #include <glib-object.h>
 #include <stddef.h>
 
+#ifdef HAVE_MADVISE
+#  include <sys/mman.h>
+#endif
+
 // clang-format off
 G_DEFINE_QUARK(rmf-loader-error-quark, rmf_loader_error)
 // clang-format on
 
 /**
  * RmfLoaderError:
- * @RMF_LOADER_ERROR_XYZ: xyz
+ * @RMF_LOADER_ERROR_TRUNCATED: The data ended in the middle of a record.
+ * @RMF_LOADER_ERROR_INVALID: The data is malformed.
  *
  * Error codes for `RMF_LOADER_ERROR`.
  */
 G_DEFINE_ENUM_TYPE(
     RmfLoaderError,
     rmf_loader_error,
-    G_DEFINE_ENUM_VALUE(RMF_LOADER_ERROR_XYZ, "xyz")
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_ERROR_TRUNCATED, "truncated"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_ERROR_INVALID, "invalid")
+)
+
+/**
+ * RmfLoaderFlags:
+ * @RMF_LOADER_FLAGS_NONE: No flags set.
+ * @RMF_LOADER_FLAGS_NO_MMAP: Read the whole file into memory instead of
+ *   memory-mapping it. Use this if the file may be truncated or rewritten
+ *   while the loader is still holding on to it.
+ * @RMF_LOADER_FLAGS_PARALLEL: Parse the children of the worldspawn on several
+ *   threads. Ignored while a trace sink is installed, since the trace has to
+ *   follow the file order.
+ * @RMF_LOADER_FLAGS_LAZY_FACES: Only decode the faces of a [class@RmfSolid]
+ *   when they are first asked for. The [struct@RmfModel] keeps the loaded data
+ *   alive, which for a memory-mapped file costs address space rather than
+ *   memory.
+ * @RMF_LOADER_FLAGS_GEOMETRY_STORE: Pack the vertices of all faces into one
+ *   [struct@RmfGeometry], see [method@RmfRoot.get_geometry]. Ignored along with
+ *   @RMF_LOADER_FLAGS_LAZY_FACES, and when loading single nodes.
+ * @RMF_LOADER_FLAGS_PLANE_TABLE: Gather the planes of all faces into one
+ *   [struct@RmfPlaneTable], see [method@RmfRoot.get_plane_table]. Along with
+ *   @RMF_LOADER_FLAGS_LAZY_FACES, this decodes every face at the end of the
+ *   load. Ignored when loading single nodes.
+ *
+ * Flags controlling how a [class@RmfLoader] loads data.
+ */
+G_DEFINE_FLAGS_TYPE(
+    RmfLoaderFlags,
+    rmf_loader_flags,
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_NONE, "none"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_NO_MMAP, "no-mmap"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_PARALLEL, "parallel"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_LAZY_FACES, "lazy-faces"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_GEOMETRY_STORE, "geometry-store"),
+    G_DEFINE_ENUM_VALUE(RMF_LOADER_FLAGS_PLANE_TABLE, "plane-table")
 )
 
+/**
+ * RmfLoaderProgressCallback:
+ * @current_bytes: Number of bytes parsed so far.
+ * @total_bytes: Total number of bytes to parse.
+ * @n_objects: Number of map objects parsed so far.
+ * @user_data: (closure): User data passed to the loading function.
+ *
+ * Reports the progress of an asynchronous load.
+ */
+
 static constexpr rmf_float RMF_MIN_SUPPORTED_VERSION = 1.6f;
 static constexpr rmf_float RMF_MAX_SUPPORTED_VERSION = 2.2f;
 
@@ -33,16 +83,6 @@ static constexpr rmf_float RMF_MAX_SUPPORTED_VERSION = 2.2f;
  *
  * (*"Various" presently meaning one).
  */
-struct _RmfLoader {
-    GObject parent_instance;
-    char const *source;
-    GBytes *data;
-    goffset offset;
-    GPtrArray *tag_stack;
-    rmf_float version;
-    RmfRoot *root;
-};
-
 G_DEFINE_FINAL_TYPE(RmfLoader, rmf_loader, G_TYPE_OBJECT)
 
 enum RmfLoaderProperty {
@@ -51,11 +91,156 @@ enum RmfLoaderProperty {
     PROP_OFFSET,
     PROP_VERSION,
     PROP_ROOT,
+    PROP_FLAGS,
+    PROP_TRACE_SINK,
+    PROP_STRING_POOL,
     N_PROPERTIES,
 };
 
 static GParamSpec *obj_properties[N_PROPERTIES];
 
+// Minimum time between two progress reports.
+static constexpr gint64 PROGRESS_INTERVAL = 100 * G_TIME_SPAN_MILLISECOND;
+
+// Progress callback of an async load, shared between the pending reports.
+struct _RmfProgress {
+    RmfLoaderProgressCallback callback;
+    gpointer user_data;
+    GDestroyNotify destroy;
+    GMainContext *context;
+};
+
+typedef struct {
+    RmfProgress *progress;
+    goffset current_bytes;
+    goffset total_bytes;
+    guint n_objects;
+} ProgressReport;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static void progress_clear(RmfProgress *progress)
+{
+    if (progress->destroy != nullptr) {
+        progress->destroy(progress->user_data);
+    }
+    g_main_context_unref(progress->context);
+}
+
+static void progress_unref(RmfProgress *progress)
+{
+    g_atomic_rc_box_release_full(progress, (GDestroyNotify)progress_clear);
+}
+
+static gboolean progress_report_dispatch(gpointer data)
+{
+    ProgressReport const *report = data;
+    report->progress->callback(
+        report->current_bytes,
+        report->total_bytes,
+        report->n_objects,
+        report->progress->user_data
+    );
+    return G_SOURCE_REMOVE;
+}
+
+static void progress_report_free(gpointer data)
+{
+    ProgressReport *report = data;
+    progress_unref(report->progress);
+    g_free(report);
+}
+
+// Queue a progress report on the context the async load was started from.
+static void report_progress(RmfLoader *self)
+{
+    auto const report = g_new(ProgressReport, 1);
+    *report = (ProgressReport){
+        .progress = g_atomic_rc_box_acquire(self->progress),
+        .current_bytes = rmf_loader_get_offset(self),
+        .total_bytes = self->cursor.end - self->cursor.base,
+        .n_objects = self->n_objects,
+    };
+    g_main_context_invoke_full(
+        self->progress->context,
+        G_PRIORITY_DEFAULT,
+        progress_report_dispatch,
+        report,
+        progress_report_free
+    );
+    self->progress_time = g_get_monotonic_time();
+}
+
+static void set_data(RmfLoader *self, GBytes *data)
+{
+    g_clear_pointer(&self->data, g_bytes_unref);
+    self->data = data ? g_bytes_ref(data) : nullptr;
+    gsize size = 0;
+    guint8 const *bytes = data ? g_bytes_get_data(data, &size) : nullptr;
+    self->cursor = (RmfCursor){
+        .base = bytes,
+        .end = bytes + size,
+        .pos = bytes,
+    };
+}
+
+// Get the file's contents, memory-mapping them where possible so parsing reads
+// straight from the page cache instead of a heap copy of the whole file.
+static GBytes *load_file_bytes(
+    GFile *file,
+    bool use_mmap,
+    GCancellable *cancellable,
+    GError **error
+)
+{
+    g_autofree char *path = use_mmap ? g_file_get_path(file) : nullptr;
+    if (path == nullptr) {
+        return g_file_load_bytes(file, cancellable, nullptr, error);
+    }
+
+    g_autoptr(GMappedFile) mapped = g_mapped_file_new(path, FALSE, error);
+    if (mapped == nullptr) {
+        return nullptr;
+    }
+
+#ifdef HAVE_MADVISE
+    auto const contents = g_mapped_file_get_contents(mapped);
+    auto const length = g_mapped_file_get_length(mapped);
+    if (contents != nullptr && length > 0) {
+        // Purely advisory, so failures are ignored.
+        (void)madvise(contents, length, MADV_SEQUENTIAL);
+        (void)madvise(contents, length, MADV_WILLNEED);
+    }
+#endif
+
+    // The GBytes keeps the mapping alive for as long as it is referenced.
+    return g_mapped_file_get_bytes(mapped);
+}
+
+// Pick the trace sink for a load. Without one installed, fall back to the XML
+// outline if "Rmf" info messages would actually be shown.
+static void begin_trace(RmfLoader *self)
+{
+#ifndef RMF_DISABLE_TRACING
+    auto const info_dropped
+        = g_log_writer_default_would_drop(G_LOG_LEVEL_INFO, G_LOG_DOMAIN);
+    if (self->trace_sink != nullptr) {
+        self->trace = g_object_ref(self->trace_sink);
+    } else if (!info_dropped) {
+        self->trace = RMF_TRACE_SINK(rmf_xml_trace_sink_new());
+    }
+    if (self->trace != nullptr) {
+        self->trace_text = rmf_trace_sink_wants_text(self->trace);
+        g_ptr_array_set_size(self->tag_stack, 0);
+    }
+#endif
+}
+
+static void end_trace(RmfLoader *self)
+{
+    g_clear_object(&self->trace);
+}
+
 // GObject /////////////////////////////////////////////////////////////////////
 
 static void rmf_loader_dispose(GObject *object)
@@ -69,6 +254,16 @@ static void rmf_loader_dispose(GObject *object)
         g_ptr_array_unref(self->tag_stack);
         self->tag_stack = nullptr;
     }
+    g_clear_object(&self->trace_sink);
+    g_clear_object(&self->trace);
+    g_clear_pointer(&self->string_pool, rmf_string_pool_unref);
+    g_clear_pointer(&self->interned, g_hash_table_unref);
+    g_clear_pointer(&self->strings, rmf_string_pool_unref);
+    self->cursor = (RmfCursor){};
+    g_clear_error(&self->error);
+    g_clear_pointer(&self->model, rmf_model_unref);
+    g_clear_pointer(&self->scratch, rmf_arena_unref);
+    g_clear_pointer(&self->arena, rmf_arena_unref);
     g_clear_object(&self->root);
     G_OBJECT_CLASS(rmf_loader_parent_class)->dispose(object);
 }
@@ -90,7 +285,7 @@ static void rmf_loader_get_property(
     auto const self = RMF_LOADER(object);
     switch ((enum RmfLoaderProperty)property_id) {
     case PROP_OFFSET:
-        g_value_set_int64(value, self->offset);
+        g_value_set_int64(value, rmf_loader_get_offset(self));
         break;
     case PROP_VERSION:
         g_value_set_float(value, self->version);
@@ -98,6 +293,15 @@ static void rmf_loader_get_property(
     case PROP_ROOT:
         g_value_set_object(value, self->root);
         break;
+    case PROP_FLAGS:
+        g_value_set_flags(value, self->flags);
+        break;
+    case PROP_TRACE_SINK:
+        g_value_set_object(value, self->trace_sink);
+        break;
+    case PROP_STRING_POOL:
+        g_value_set_boxed(value, self->string_pool);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
         break;
@@ -118,15 +322,26 @@ static void rmf_loader_set_property(
         self->source = g_value_dup_string(value);
         break;
     case PROP_DATA:
-        g_bytes_unref(self->data);
-        self->data = g_value_dup_boxed(value);
+        set_data(self, g_value_get_boxed(value));
         break;
     case PROP_OFFSET:
-        self->offset = g_value_get_int64(value);
+        rmf_loader_set_offset(self, g_value_get_int64(value));
         break;
     case PROP_ROOT:
+        g_clear_object(&self->root);
         self->root = g_value_dup_object(value);
         break;
+    case PROP_FLAGS:
+        self->flags = g_value_get_flags(value);
+        break;
+    case PROP_TRACE_SINK:
+        g_clear_object(&self->trace_sink);
+        self->trace_sink = g_value_dup_object(value);
+        break;
+    case PROP_STRING_POOL:
+        g_clear_pointer(&self->string_pool, rmf_string_pool_unref);
+        self->string_pool = g_value_dup_boxed(value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
         break;
@@ -212,6 +427,52 @@ static void rmf_loader_class_init(RmfLoaderClass *klass)
         G_PARAM_READWRITE
     );
 
+    /**
+     * RmfLoader:flags
+     *
+     * Flags controlling how data is loaded.
+     */
+    obj_properties[PROP_FLAGS] = g_param_spec_flags(
+        "flags",
+        nullptr,
+        nullptr,
+        RMF_TYPE_LOADER_FLAGS,
+        RMF_LOADER_FLAGS_NONE,
+        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+    );
+
+    /**
+     * RmfLoader:trace-sink
+     *
+     * Sink which receives a trace of the data as it is parsed.
+     *
+     * If unset, an [class@RmfXmlTraceSink] is used whenever `Rmf` info
+     * messages are enabled (eg. with `G_MESSAGES_DEBUG=Rmf`). Otherwise
+     * nothing is traced.
+     */
+    obj_properties[PROP_TRACE_SINK] = g_param_spec_object(
+        "trace-sink",
+        nullptr,
+        nullptr,
+        RMF_TYPE_TRACE_SINK,
+        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+    );
+
+    /**
+     * RmfLoader:string-pool
+     *
+     * Pool which loaded strings are interned into, shared between loads.
+     *
+     * If unset, each load interns into a new pool of its own.
+     */
+    obj_properties[PROP_STRING_POOL] = g_param_spec_boxed(
+        "string-pool",
+        nullptr,
+        nullptr,
+        RMF_TYPE_STRING_POOL,
+        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+    );
+
     g_object_class_install_properties(oclass, N_PROPERTIES, obj_properties);
 }
 
@@ -235,29 +496,135 @@ RmfLoader *rmf_loader_new(void)
 }
 
 /**
- * rmf_loader_load_from_file:
+ * rmf_loader_get_flags:
  * @loader: The loader.
- * @file: File to source the data from.
- * @error: Return location for [a recoverable
- * error](https://docs.gtk.org/glib/error-reporting.html#rules-for-use-of-gerror).
  *
- * Load RMF data from a file.
+ * Get the flags controlling how data is loaded.
+ *
+ * Returns: The loader's flags.
  */
-void rmf_loader_load_from_file(RmfLoader *self, GFile *file, GError **error)
+RmfLoaderFlags rmf_loader_get_flags(RmfLoader *self)
 {
-    g_return_if_fail(RMF_IS_LOADER(self));
-    g_return_if_fail(G_IS_FILE(file));
-    g_return_if_fail(error == nullptr || *error == nullptr);
+    g_return_val_if_fail(RMF_IS_LOADER(self), RMF_LOADER_FLAGS_NONE);
+    return self->flags;
+}
 
-    g_autoptr(GBytes) data = g_file_load_bytes(file, nullptr, nullptr, error);
-    if (error && *error) {
-        return;
+/**
+ * rmf_loader_set_flags:
+ * @loader: The loader.
+ * @flags: The new flags.
+ *
+ * Set the flags controlling how data is loaded. The flags take effect on the
+ * next load.
+ */
+void rmf_loader_set_flags(RmfLoader *self, RmfLoaderFlags flags)
+{
+    g_object_set(self, "flags", flags, nullptr);
+}
+
+/**
+ * rmf_loader_get_trace_sink:
+ * @loader: The loader.
+ *
+ * Get the sink which receives a trace of the data as it is parsed.
+ *
+ * Returns: (transfer none) (nullable): The trace sink.
+ */
+RmfTraceSink *rmf_loader_get_trace_sink(RmfLoader *self)
+{
+    g_return_val_if_fail(RMF_IS_LOADER(self), nullptr);
+    return self->trace_sink;
+}
+
+/**
+ * rmf_loader_set_trace_sink:
+ * @loader: The loader.
+ * @sink: (nullable): The new trace sink, or `NULL` to trace nothing.
+ *
+ * Set the sink which receives a trace of the data as it is parsed.
+ */
+void rmf_loader_set_trace_sink(RmfLoader *self, RmfTraceSink *sink)
+{
+    g_object_set(self, "trace-sink", sink, nullptr);
+}
+
+/**
+ * rmf_loader_get_string_pool:
+ * @loader: The loader.
+ *
+ * Get the pool which loaded strings are interned into.
+ *
+ * Returns: (transfer none) (nullable): The string pool.
+ */
+RmfStringPool *rmf_loader_get_string_pool(RmfLoader *self)
+{
+    g_return_val_if_fail(RMF_IS_LOADER(self), nullptr);
+    return self->string_pool;
+}
+
+/**
+ * rmf_loader_set_string_pool:
+ * @loader: The loader.
+ * @pool: (nullable): The new string pool, or `NULL` to use a new pool for each
+ *   load.
+ *
+ * Set the pool which loaded strings are interned into. Share a pool between
+ * loaders to store strings repeated across maps only once.
+ */
+void rmf_loader_set_string_pool(RmfLoader *self, RmfStringPool *pool)
+{
+    g_object_set(self, "string-pool", pool, nullptr);
+}
+
+// Set up the model, arena and string pool for the records of a load.
+static void begin_records(RmfLoader *self)
+{
+    self->strings = self->string_pool ? rmf_string_pool_ref(self->string_pool)
+                                      : rmf_string_pool_new();
+    self->arena = rmf_arena_new();
+    rmf_arena_keep(
+        self->arena,
+        rmf_string_pool_ref(self->strings),
+        (GDestroyNotify)rmf_string_pool_unref
+    );
+    self->model = rmf_model_new(self);
+}
+
+static void end_records(RmfLoader *self)
+{
+    if (!rmf_loader_failed(self)) {
+        rmf_model_build_preorder(self->model);
+        rmf_model_build_bounds(self->model);
+    }
+    g_clear_pointer(&self->model, rmf_model_unref);
+    g_clear_pointer(&self->scratch, rmf_arena_unref);
+    g_clear_pointer(&self->arena, rmf_arena_unref);
+    g_clear_pointer(&self->interned, g_hash_table_unref);
+    g_clear_pointer(&self->strings, rmf_string_pool_unref);
+}
+
+// Open @file and read its header, leaving the cursor at the visgroups. Safe to
+// call from a worker thread: no properties are set or notified here.
+static bool open_file(
+    RmfLoader *self,
+    GFile *file,
+    GCancellable *cancellable,
+    GError **error
+)
+{
+    bool const use_mmap = !(self->flags & RMF_LOADER_FLAGS_NO_MMAP);
+    g_autoptr(GBytes) data
+        = load_file_bytes(file, use_mmap, cancellable, error);
+    if (data == nullptr) {
+        return false;
     }
-    g_autofree char *filename = g_file_get_path(file);
-    g_autofree char *source = g_filename_display_basename(filename);
+    g_autofree char *basename = g_file_get_basename(file);
 
-    g_object_set(self, "source", source, "data", data, nullptr);
-    rmf_loader_set_offset(self, 0);
+    g_free((gpointer)self->source);
+    self->source = g_filename_display_name(basename);
+    set_data(self, data);
+    g_clear_error(&self->error);
+    self->n_objects = 0;
 
     rmf_read_float(self, &self->version);
     if (self->version < RMF_MIN_SUPPORTED_VERSION
@@ -270,17 +637,332 @@ void rmf_loader_load_from_file(RmfLoader *self, GFile *file, GError **error)
             RMF_MAX_SUPPORTED_VERSION
         );
     }
+    self->readers = rmf_readers_for_version(self->version);
 
     char magic[3];
     rmf_loader_read(self, 3, magic);
     if (memcmp(magic, "RMF", 3) != 0) {
         g_printerr("Invalid RMF magic number \"%.3s\"\n", magic);
     }
+    return true;
+}
+
+// Open and parse @file, returning the new root. Safe to call from a worker
+// thread, like open_file().
+static RmfRoot *load_file(
+    RmfLoader *self,
+    GFile *file,
+    GCancellable *cancellable,
+    GError **error
+)
+{
+    if (!open_file(self, file, cancellable, error)) {
+        return nullptr;
+    }
+    self->cancellable = cancellable;
+    self->progress_time = g_get_monotonic_time();
+    begin_records(self);
+    if ((self->flags & RMF_LOADER_FLAGS_GEOMETRY_STORE)
+        && !(self->flags & RMF_LOADER_FLAGS_LAZY_FACES))
+    {
+        self->scratch = rmf_arena_new();
+    }
+
+    g_autoptr(RmfRoot) root = nullptr;
+    if (!rmf_loader_failed(self)) {
+        begin_trace(self);
+        RMF_TRACE_BEGIN(self, "rmf", "version=\"%g\"", self->version);
+        root = rmf_root_new(self);
+        RMF_TRACE_END(self);
+        end_trace(self);
+    }
+    self->cancellable = nullptr;
+    end_records(self);
+
+    if (self->progress != nullptr) {
+        report_progress(self);
+    }
+
+    if (rmf_loader_failed(self)) {
+        g_propagate_error(error, g_steal_pointer(&self->error));
+        return nullptr;
+    }
+    return g_steal_pointer(&root);
+}
+
+static void
+load_thread(GTask *task, gpointer object, gpointer data, GCancellable *cancel)
+{
+    auto const self = RMF_LOADER(object);
+    GError *error = nullptr;
+    auto const root = load_file(self, G_FILE(data), cancel, &error);
+
+    g_clear_pointer(&self->progress, progress_unref);
+    g_atomic_int_set(&self->busy, FALSE);
+
+    if (root != nullptr) {
+        g_task_return_pointer(task, root, g_object_unref);
+    } else {
+        g_task_return_error(task, error);
+    }
+}
+
+/**
+ * rmf_loader_load_from_file:
+ * @loader: The loader.
+ * @file: File to source the data from.
+ * @error: Return location for [a recoverable
+ * error](https://docs.gtk.org/glib/error-reporting.html#rules-for-use-of-gerror).
+ *
+ * Load RMF data from a file.
+ *
+ * Local files are memory-mapped rather than read into memory, unless
+ * [flags@RmfLoaderFlags.NO_MMAP] is set.
+ *
+ * See [method@RmfLoader.load_from_file_async] for the asynchronous version of
+ * this function.
+ */
+void rmf_loader_load_from_file(RmfLoader *self, GFile *file, GError **error)
+{
+    g_return_if_fail(RMF_IS_LOADER(self));
+    g_return_if_fail(G_IS_FILE(file));
+    g_return_if_fail(error == nullptr || *error == nullptr);
+
+    if (!g_atomic_int_compare_and_exchange(&self->busy, FALSE, TRUE)) {
+        g_set_error_literal(
+            error,
+            G_IO_ERROR,
+            G_IO_ERROR_PENDING,
+            "The loader is already loading"
+        );
+        return;
+    }
+    g_autoptr(RmfRoot) root = load_file(self, file, nullptr, error);
+    g_atomic_int_set(&self->busy, FALSE);
+
+    // The offset is only tracked by the cursor while parsing.
+    g_object_notify_by_pspec(G_OBJECT(self), obj_properties[PROP_OFFSET]);
+
+    if (root != nullptr) {
+        g_object_set(self, "root", root, nullptr);
+    }
+}
+
+/**
+ * rmf_loader_load_from_file_async:
+ * @loader: The loader.
+ * @file: File to source the data from.
+ * @cancellable: (nullable): Optional `GCancellable` object, `NULL` to ignore.
+ * @progress_callback: (nullable) (scope notified) (closure progress_data)
+ *   (destroy progress_data_free): Function to call with progress updates.
+ * @progress_data: User data to pass to @progress_callback.
+ * @progress_data_free: (nullable): Function to free @progress_data with.
+ * @callback: (scope async): Callback to call when the load is finished.
+ * @user_data: (closure callback): User data to pass to @callback.
+ *
+ * Load RMF data from a file, parsing it on a worker thread.
+ *
+ * Cancellation is checked before each map object is parsed. Progress is
+ * reported on the thread-default main context of the caller, at most every
+ * 100 milliseconds and once more when parsing is done.
+ *
+ * The loader must not be used until @callback has been called. Call
+ * [method@RmfLoader.load_from_file_finish] from @callback to get the result.
+ */
+void rmf_loader_load_from_file_async(
+    RmfLoader *self,
+    GFile *file,
+    GCancellable *cancellable,
+    RmfLoaderProgressCallback progress_callback,
+    gpointer progress_data,
+    GDestroyNotify progress_data_free,
+    GAsyncReadyCallback callback,
+    gpointer user_data
+)
+{
+    g_return_if_fail(RMF_IS_LOADER(self));
+    g_return_if_fail(G_IS_FILE(file));
+    g_return_if_fail(cancellable == nullptr || G_IS_CANCELLABLE(cancellable));
+
+    g_autoptr(GTask) task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, rmf_loader_load_from_file_async);
+
+    if (!g_atomic_int_compare_and_exchange(&self->busy, FALSE, TRUE)) {
+        if (progress_data_free != nullptr) {
+            progress_data_free(progress_data);
+        }
+        g_task_return_new_error(
+            task,
+            G_IO_ERROR,
+            G_IO_ERROR_PENDING,
+            "The loader is already loading"
+        );
+        return;
+    }
+
+    if (progress_callback != nullptr) {
+        self->progress = g_atomic_rc_box_new(RmfProgress);
+        *self->progress = (RmfProgress){
+            .callback = progress_callback,
+            .user_data = progress_data,
+            .destroy = progress_data_free,
+            .context = g_main_context_ref_thread_default(),
+        };
+    } else if (progress_data_free != nullptr) {
+        progress_data_free(progress_data);
+    }
 
-    rmf_loader_log_begin(self, "rmf", "version", "%g", self->version, nullptr);
-    auto root = rmf_root_new(self);
+    g_task_set_task_data(task, g_object_ref(file), g_object_unref);
+    g_task_run_in_thread(task, load_thread);
+}
+
+/**
+ * rmf_loader_load_from_file_finish:
+ * @loader: The loader.
+ * @result: The `GAsyncResult` passed to the callback.
+ * @error: Return location for [a recoverable
+ * error](https://docs.gtk.org/glib/error-reporting.html#rules-for-use-of-gerror).
+ *
+ * Finish a load started with [method@RmfLoader.load_from_file_async].
+ *
+ * Returns: `TRUE` on success, `FALSE` if @error is set.
+ */
+gboolean rmf_loader_load_from_file_finish(
+    RmfLoader *self,
+    GAsyncResult *result,
+    GError **error
+)
+{
+    g_return_val_if_fail(RMF_IS_LOADER(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+    g_return_val_if_fail(
+        g_task_get_source_tag(G_TASK(result))
+            == rmf_loader_load_from_file_async,
+        FALSE
+    );
+
+    g_autoptr(RmfRoot) root = g_task_propagate_pointer(G_TASK(result), error);
+
+    g_object_notify_by_pspec(G_OBJECT(self), obj_properties[PROP_OFFSET]);
+
+    if (root == nullptr) {
+        return FALSE;
+    }
     g_object_set(self, "root", root, nullptr);
-    rmf_loader_log_end(self);
+    return TRUE;
+}
+
+/**
+ * rmf_loader_scan_file:
+ * @loader: The loader.
+ * @file: File to source the data from.
+ * @error: Return location for [a recoverable
+ * error](https://docs.gtk.org/glib/error-reporting.html#rules-for-use-of-gerror).
+ *
+ * Find the extent of every map object in a file, without building any of them.
+ *
+ * Only the counts needed to step over each record are read, so this is much
+ * cheaper than [method@RmfLoader.load_from_file]. The table lists the objects
+ * in file order, starting with the worldspawn; each object comes before its
+ * children. The loader keeps the file's data, so that single objects can then
+ * be built with [method@RmfLoader.load_node].
+ *
+ * Returns: (transfer full) (element-type RmfNode) (nullable): The table of
+ * map objects, or `NULL` if @error is set.
+ */
+GArray *rmf_loader_scan_file(RmfLoader *self, GFile *file, GError **error)
+{
+    g_return_val_if_fail(RMF_IS_LOADER(self), nullptr);
+    g_return_val_if_fail(G_IS_FILE(file), nullptr);
+    g_return_val_if_fail(error == nullptr || *error == nullptr, nullptr);
+
+    if (!g_atomic_int_compare_and_exchange(&self->busy, FALSE, TRUE)) {
+        g_set_error_literal(
+            error,
+            G_IO_ERROR,
+            G_IO_ERROR_PENDING,
+            "The loader is already loading"
+        );
+        return nullptr;
+    }
+
+    g_autoptr(GArray) nodes = nullptr;
+    if (open_file(self, file, nullptr, error)) {
+        nodes = g_array_new(FALSE, FALSE, sizeof(RmfNode));
+
+        rmf_int n_visgroups = 0;
+        rmf_read_count(self, &n_visgroups, 1);
+        for (rmf_int i = 0; i < n_visgroups; ++i) {
+            rmf_skip_visgroup(self);
+        }
+        rmf_scan_map_object(self, nodes, RMF_NODE_NO_PARENT, 0);
+
+        if (rmf_loader_failed(self)) {
+            g_propagate_error(error, g_steal_pointer(&self->error));
+            g_clear_pointer(&nodes, g_array_unref);
+        }
+    }
+    g_atomic_int_set(&self->busy, FALSE);
+
+    g_object_notify_by_pspec(G_OBJECT(self), obj_properties[PROP_OFFSET]);
+    return g_steal_pointer(&nodes);
+}
+
+/**
+ * rmf_loader_load_node:
+ * @loader: The loader.
+ * @node: A node from the table returned by [method@RmfLoader.scan_file].
+ * @error: Return location for [a recoverable
+ * error](https://docs.gtk.org/glib/error-reporting.html#rules-for-use-of-gerror).
+ *
+ * Build the map object recorded in @node, along with all of its children, from
+ * the data of the last scanned or loaded file.
+ *
+ * Returns: (transfer full) (nullable): The map object, or `NULL` if @error is
+ * set.
+ */
+RmfMapObject *
+rmf_loader_load_node(RmfLoader *self, RmfNode const *node, GError **error)
+{
+    g_return_val_if_fail(RMF_IS_LOADER(self), nullptr);
+    g_return_val_if_fail(node != nullptr, nullptr);
+    g_return_val_if_fail(error == nullptr || *error == nullptr, nullptr);
+    g_return_val_if_fail(self->data != nullptr, nullptr);
+
+    if (!g_atomic_int_compare_and_exchange(&self->busy, FALSE, TRUE)) {
+        g_set_error_literal(
+            error,
+            G_IO_ERROR,
+            G_IO_ERROR_PENDING,
+            "The loader is already loading"
+        );
+        return nullptr;
+    }
+    g_clear_error(&self->error);
+
+    rmf_loader_set_offset(self, node->offset);
+    g_autoptr(RmfModel) model = rmf_loader_read_model(self);
+    if (!rmf_loader_failed(self)
+        && (rmf_model_node(model, 0)->object_type != node->object_type
+            || (goffset)rmf_loader_get_offset(self) - node->offset
+                   != node->length))
+    {
+        rmf_loader_fail(
+            self,
+            RMF_LOADER_ERROR_INVALID,
+            "Node at offset %" G_GOFFSET_FORMAT " does not match the data",
+            node->offset
+        );
+    }
+    g_atomic_int_set(&self->busy, FALSE);
+
+    g_object_notify_by_pspec(G_OBJECT(self), obj_properties[PROP_OFFSET]);
+
+    if (rmf_loader_failed(self)) {
+        g_propagate_error(error, g_steal_pointer(&self->error));
+        return nullptr;
+    }
+    return rmf_model_get_object(model, 0);
 }
 
 /**
@@ -293,9 +975,8 @@ void rmf_loader_load_from_file(RmfLoader *self, GFile *file, GError **error)
  */
 RmfRoot *rmf_loader_get_root(RmfLoader *self)
 {
-    RmfRoot *value = nullptr;
-    g_object_get(self, "root", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_LOADER(self), nullptr);
+    return self->root;
 }
 
 /**
@@ -308,108 +989,208 @@ RmfRoot *rmf_loader_get_root(RmfLoader *self)
  */
 rmf_float rmf_loader_get_version(RmfLoader *self)
 {
-    rmf_float version = 0.f;
-    g_object_get(self, "version", &version, nullptr);
-    return version;
+    g_return_val_if_fail(RMF_IS_LOADER(self), 0.f);
+    return self->version;
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-void rmf_loader_set_offset(RmfLoader *self, size_t offset)
+// Make a loader reading the same data as @self with its own cursor, so that
+// parts of the data can be parsed on another thread. The fork shares the
+// cancellable but does not trace or report progress. The fork parses into a
+// model and arenas of its own, to be grafted into those of @self.
+RmfLoader *rmf_loader_fork(RmfLoader *self)
 {
-    g_object_set(self, "offset", offset, nullptr);
+    auto const fork = rmf_loader_new_for_data(
+        self->data,
+        self->readers,
+        self->strings,
+        rmf_loader_get_offset(self)
+    );
+    fork->source = g_strdup(self->source);
+    fork->version = self->version;
+    fork->flags = self->flags;
+    fork->cancellable = self->cancellable;
+    fork->arena = rmf_arena_new();
+    if (self->scratch != nullptr) {
+        fork->scratch = rmf_arena_new();
+    }
+    fork->model = rmf_model_new(fork);
+    return fork;
 }
 
-void rmf_loader_seek(RmfLoader *self, goffset n)
+// Make a loader for re-reading faces out of @data after the load they came
+// from, to decode the faces of a lazy RmfSolid. Faces are allocated from the
+// heap, and their texture names interned into @strings. Other records need an
+// arena, so they can't be read with it.
+RmfLoader *rmf_loader_new_for_data(
+    GBytes *data,
+    RmfReaders const *readers,
+    RmfStringPool *strings,
+    size_t offset
+)
 {
-    rmf_loader_set_offset(self, self->offset + n);
+    RmfLoader *self = g_object_new(RMF_TYPE_LOADER, nullptr);
+    set_data(self, data);
+    self->readers = readers;
+    self->strings = rmf_string_pool_ref(strings);
+    rmf_loader_set_offset(self, offset);
+    return self;
 }
 
-void rmf_loader_read(RmfLoader *self, size_t n, void *dest)
+// Parse the map object at the cursor, with all of its children, into a model
+// of its own with the object at index 0.
+RmfModel *rmf_loader_read_model(RmfLoader *self)
 {
-    g_return_if_fail(dest);
-    auto const src = g_bytes_get_region(self->data, 1, self->offset, n);
-    memcpy(dest, src, n);
-    self->offset += n;
+    begin_records(self);
+    rmf_read_map_object(self, rmf_model_add_nodes(self->model, 1));
+    auto const model = rmf_model_ref(self->model);
+    end_records(self);
+    return model;
 }
 
-// Helper for rmf_loader_log_* funcs
-static char *make_tag(char const *tag, va_list ap)
+// Stop parsing with @error, taking ownership of it. Only the first error of a
+// load is kept.
+void rmf_loader_abort(RmfLoader *self, GError *error)
 {
-    g_autoptr(GStrvBuilder) builder = g_strv_builder_new();
-    g_strv_builder_add(builder, tag);
+    // Jump to the end so any further reads fail fast and parsing unwinds.
+    self->cursor.pos = self->cursor.end;
+    if (self->error != nullptr) {
+        g_error_free(error);
+        return;
+    }
+    self->error = error;
+}
 
-    for (char const *attr = va_arg(ap, char const *); attr != nullptr;
-         attr = va_arg(ap, char const *))
-    {
-        char const *attrfmt = va_arg(ap, char const *);
-        g_autofree auto fmt
-            = g_strjoin(nullptr, attr, "=\"", attrfmt, "\"", nullptr);
-        g_strv_builder_take(builder, g_strdup_vprintf(fmt, ap));
+void rmf_loader_fail(RmfLoader *self, gint code, char const *format, ...)
+{
+    if (self->error != nullptr) {
+        self->cursor.pos = self->cursor.end;
+        return;
     }
 
-    g_auto(GStrv) strv = g_strv_builder_end(builder);
-    auto result = g_strjoinv(" ", strv);
+    va_list ap;
+    va_start(ap, format);
+    g_autofree auto message = g_strdup_vprintf(format, ap);
+    va_end(ap);
 
-    return result;
+    if (self->source != nullptr) {
+        rmf_loader_abort(
+            self,
+            g_error_new(RMF_LOADER_ERROR, code, "%s: %s", self->source, message)
+        );
+    } else {
+        rmf_loader_abort(
+            self,
+            g_error_new_literal(RMF_LOADER_ERROR, code, message)
+        );
+    }
 }
 
-static char *indent(unsigned int n, char const *str)
+// Intern a null-padded string field of @size bytes. Strings seen before are
+// found in the loader's own set, so that forks parsing on several threads only
+// take the lock of the shared pool for strings new to them.
+char const *
+rmf_loader_intern(RmfLoader *self, guint8 const *string, size_t size)
 {
-    constexpr unsigned int INDENT_WIDTH = 2;
+    char buffer[256 + 1];
+    auto const length = strnlen((char const *)string, MIN(size, 256));
+    memcpy(buffer, string, length);
+    buffer[length] = '\0';
+
+    if (self->interned == nullptr) {
+        self->interned = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+    char const *interned = g_hash_table_lookup(self->interned, buffer);
+    if (interned == nullptr) {
+        interned = rmf_string_pool_intern(self->strings, buffer);
+        g_hash_table_add(self->interned, (gpointer)interned);
+    }
+    return interned;
+}
 
-    g_autoptr(GStrvBuilder) builder = g_strv_builder_new();
-    for (unsigned int i = 0; i < n * INDENT_WIDTH; ++i) {
-        g_strv_builder_add(builder, " ");
+void rmf_loader_tick_slow(RmfLoader *self)
+{
+    GError *error = nullptr;
+    if (g_cancellable_set_error_if_cancelled(self->cancellable, &error)) {
+        rmf_loader_abort(self, error);
+        return;
     }
-    g_strv_builder_add(builder, str);
 
-    g_auto(GStrv) str_array = g_strv_builder_end(builder);
-    auto s = g_strjoinv(nullptr, str_array);
-    return s;
+    if (self->progress != nullptr) {
+        auto const now = g_get_monotonic_time();
+        if (now - self->progress_time >= PROGRESS_INTERVAL) {
+            report_progress(self);
+        }
+    }
 }
 
-void rmf_loader_log_begin(RmfLoader *self, char const *tag, ...)
+// Shared by the rmf_loader_trace_* funcs.
+static void emit_trace(
+    RmfLoader *self,
+    RmfTraceKind kind,
+    char const *tag,
+    char const *content,
+    char const *format,
+    va_list ap
+)
 {
-    g_ptr_array_add(self->tag_stack, (void *)tag);
+    g_autofree char *attributes = nullptr;
+    if (self->trace_text && format != nullptr) {
+        attributes = g_strdup_vprintf(format, ap);
+    }
 
+    RmfTraceRecord const record = {
+        .kind = kind,
+        .source = self->source,
+        .offset = rmf_loader_get_offset(self),
+        .depth = self->tag_stack->len,
+        .tag = tag,
+        .attributes = attributes,
+        .content = self->trace_text ? content : nullptr,
+    };
+    rmf_trace_sink_record(self->trace, &record);
+}
+
+void rmf_loader_trace_begin(
+    RmfLoader *self,
+    char const *tag,
+    char const *format,
+    ...
+)
+{
     va_list ap;
-    va_start(ap, tag);
-    g_autofree auto result = make_tag(tag, ap);
+    va_start(ap, format);
+    emit_trace(self, RMF_TRACE_KIND_BEGIN, tag, nullptr, format, ap);
     va_end(ap);
-
-    g_autofree auto xml = g_strdup_printf("<%s>", result);
-    g_autofree auto indented = indent(self->tag_stack->len - 1, xml);
-    g_info("%s+%08" G_GOFFSET_FORMAT "x: %s", self->source, self->offset, indented);
+    g_ptr_array_add(self->tag_stack, (void *)tag);
 }
 
-void rmf_loader_log_oneline(
+void rmf_loader_trace_oneline(
     RmfLoader *self,
     char const *tag,
     char const *content,
+    char const *format,
     ...
 )
 {
     va_list ap;
-    va_start(ap, content);
-    g_autofree auto result = make_tag(tag, ap);
+    va_start(ap, format);
+    emit_trace(self, RMF_TRACE_KIND_ONELINE, tag, content, format, ap);
     va_end(ap);
-
-    g_autofree char *xml = nullptr;
-    if (content == nullptr) {
-        xml = g_strdup_printf("<%s/>", result);
-    } else {
-        xml = g_strdup_printf("<%s>%s</%s>", result, content, tag);
-    }
-    g_autofree auto indented = indent(self->tag_stack->len, xml);
-    g_info("%s+%08" G_GOFFSET_FORMAT "x: %s", self->source, self->offset, indented);
 }
 
-void rmf_loader_log_end(RmfLoader *self)
+void rmf_loader_trace_end(RmfLoader *self)
 {
-    char *tag
-        = g_ptr_array_remove_index(self->tag_stack, self->tag_stack->len - 1);
-    g_autofree auto xml = g_strdup_printf("</%s>", tag);
-    g_autofree auto indented = indent(self->tag_stack->len, xml);
-    g_info("%s+%08" G_GOFFSET_FORMAT "x: %s", self->source, self->offset, indented);
+    g_return_if_fail(self->tag_stack->len > 0);
+    char const *tag
+        = g_ptr_array_steal_index(self->tag_stack, self->tag_stack->len - 1);
+    RmfTraceRecord const record = {
+        .kind = RMF_TRACE_KIND_END,
+        .source = self->source,
+        .offset = rmf_loader_get_offset(self),
+        .depth = self->tag_stack->len,
+        .tag = tag,
+    };
+    rmf_trace_sink_record(self->trace, &record);
 }
@@ -5,6 +5,8 @@
 #  error "Only <rmf.h> can be included directly."
 #endif
 
+#include "rmf/rmf-stringpool.h"
+#include "rmf/rmf-trace.h"
 #include "rmf/rmf-types.h"
 
 #include <gio/gio.h>
@@ -13,6 +15,8 @@
 
 G_BEGIN_DECLS
 
+typedef struct _RmfMapObject RmfMapObject;
+typedef struct _RmfNode RmfNode;
 typedef struct _RmfRoot RmfRoot;
 
 // RmfLoaderError
@@ -25,18 +29,71 @@ typedef struct _RmfRoot RmfRoot;
 #define RMF_LOADER_ERROR rmf_loader_error_quark()
 
 typedef enum {
-    // TODO
-    RMF_LOADER_ERROR_XYZ,
+    RMF_LOADER_ERROR_TRUNCATED,
+    RMF_LOADER_ERROR_INVALID,
 } RmfLoaderError;
 
+// RmfLoaderFlags
+
+#define RMF_TYPE_LOADER_FLAGS rmf_loader_flags_get_type()
+
+typedef enum {
+    RMF_LOADER_FLAGS_NONE = 0,
+    RMF_LOADER_FLAGS_NO_MMAP = 1 << 0,
+    RMF_LOADER_FLAGS_PARALLEL = 1 << 1,
+    RMF_LOADER_FLAGS_LAZY_FACES = 1 << 2,
+    RMF_LOADER_FLAGS_GEOMETRY_STORE = 1 << 3,
+    RMF_LOADER_FLAGS_PLANE_TABLE = 1 << 4,
+} RmfLoaderFlags;
+
+GType rmf_loader_flags_get_type(void);
+
 // RmfLoader
 
 #define RMF_TYPE_LOADER rmf_loader_get_type()
 G_DECLARE_FINAL_TYPE(RmfLoader, rmf_loader, RMF, LOADER, GObject)
 
+typedef void (*RmfLoaderProgressCallback)(
+    goffset current_bytes,
+    goffset total_bytes,
+    guint n_objects,
+    gpointer user_data
+);
+
 RmfLoader *rmf_loader_new(void);
 
+RmfLoaderFlags rmf_loader_get_flags(RmfLoader *loader);
+void rmf_loader_set_flags(RmfLoader *loader, RmfLoaderFlags flags);
+
+RmfTraceSink *rmf_loader_get_trace_sink(RmfLoader *loader);
+void rmf_loader_set_trace_sink(RmfLoader *loader, RmfTraceSink *sink);
+
+RmfStringPool *rmf_loader_get_string_pool(RmfLoader *loader);
+void rmf_loader_set_string_pool(RmfLoader *loader, RmfStringPool *pool);
+
 void rmf_loader_load_from_file(RmfLoader *loader, GFile *file, GError **error);
+void rmf_loader_load_from_file_async(
+    RmfLoader *loader,
+    GFile *file,
+    GCancellable *cancellable,
+    RmfLoaderProgressCallback progress_callback,
+    gpointer progress_data,
+    GDestroyNotify progress_data_free,
+    GAsyncReadyCallback callback,
+    gpointer user_data
+);
+gboolean rmf_loader_load_from_file_finish(
+    RmfLoader *loader,
+    GAsyncResult *result,
+    GError **error
+);
+
+GArray *rmf_loader_scan_file(RmfLoader *loader, GFile *file, GError **error);
+RmfMapObject *rmf_loader_load_node(
+    RmfLoader *loader,
+    RmfNode const *node,
+    GError **error
+);
 
 RmfRoot *rmf_loader_get_root(RmfLoader *loader);
 
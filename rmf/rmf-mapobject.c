@@ -61,12 +61,14 @@ RMF_DEFINE_ITERATOR_TYPE(
  *
  * All map object types ([class@RmfWorldspawn], [class@RmfSolid],
  * [class@RmfEntity], and [class@RmfGroup]) are derived from this type.
+ *
+ * Map objects are views onto a node of an [struct@RmfModel], made when first
+ * asked for.
  */
 typedef struct {
-    RmfObjectType object_type;
-    rmf_int visgroup_id;
-    RmfColor color;
-    GPtrArray *children;
+    RmfModel *model; // Holds the object's node, unless never loaded.
+    rmf_int index;
+    GPtrArray *children; // Made on first use.
 } RmfMapObjectPrivate;
 
 enum Property {
@@ -82,22 +84,177 @@ static GParamSpec *obj_properties[N_PROPERTIES];
 
 G_DEFINE_TYPE_WITH_PRIVATE(RmfMapObject, rmf_map_object, G_TYPE_OBJECT)
 
+// Below this many children, the pre-scan and thread hand-off cost more than
+// parsing in parallel saves.
+static constexpr rmf_int PARALLEL_MIN_CHILDREN = 256;
+
+// Number of children handed to a thread at a time.
+static constexpr guint PARALLEL_GRAIN = 32;
+
+typedef struct {
+    RmfLoader *loader;
+    size_t const *offsets; // Where each child starts, and where the last ends.
+    RmfModelMark *marks;   // Per child, where its records start and end.
+    guint *workers;        // Per child, the worker which parsed it.
+    RmfLoader **forks;     // Per worker, created on first use.
+    rmf_int *failed_at;    // Per worker, index of the child its fork failed on.
+} ParallelLoad;
+
+// Node of an object which was never loaded.
+static RmfModelNode const empty_node = {};
+
 // Private /////////////////////////////////////////////////////////////////////
 
-static RmfObjectType object_type_from_nstring(rmf_nstring const *nstring)
+static void load_children_range(
+    guint begin,
+    guint end,
+    guint worker,
+    gpointer user_data
+)
 {
-    if (strncmp(nstring->data, "CMapWorld", nstring->length) == 0) {
-        return RMF_OBJECT_TYPE_WORLD;
-    } else if (strncmp(nstring->data, "CMapSolid", nstring->length) == 0) {
-        return RMF_OBJECT_TYPE_SOLID;
-    } else if (strncmp(nstring->data, "CMapEntity", nstring->length) == 0) {
-        return RMF_OBJECT_TYPE_ENTITY;
-    } else if (strncmp(nstring->data, "CMapGroup", nstring->length) == 0) {
-        return RMF_OBJECT_TYPE_GROUP;
+    ParallelLoad *load = user_data;
+    if (load->forks[worker] == nullptr) {
+        load->forks[worker] = rmf_loader_fork(load->loader);
+    }
+    auto const fork = load->forks[worker];
+
+    for (guint i = begin; i < end && !rmf_loader_failed(fork); ++i) {
+        rmf_loader_set_offset(fork, load->offsets[i]);
+        rmf_model_mark(fork->model, &load->marks[2 * i]);
+        auto const index = rmf_model_add_nodes(fork->model, 1);
+        rmf_read_map_object(fork, index);
+        rmf_model_mark(fork->model, &load->marks[2 * i + 1]);
+        load->workers[i] = worker;
+
+        if (!rmf_loader_failed(fork)
+            && rmf_loader_get_offset(fork) != load->offsets[i + 1])
+        {
+            rmf_loader_fail(
+                fork,
+                RMF_LOADER_ERROR_INVALID,
+                "Object at offset %zu does not end where expected",
+                load->offsets[i]
+            );
+        }
+        if (rmf_loader_failed(fork)) {
+            load->failed_at[worker] = i;
+        }
+    }
+}
+
+// Parse the @n children at the cursor into nodes @first onwards, on the shared
+// thread pool. Each thread parses into a model of its own, with its own fork of
+// @loader, and the subtrees are grafted into @loader's model in file order. A
+// quick pre-scan finds where every child starts. Like parsing in order, the
+// first child which fails sets @loader's error.
+static void load_children_parallel(RmfLoader *loader, rmf_int first, rmf_int n)
+{
+    g_autofree size_t *offsets = g_new(size_t, n + 1);
+    for (rmf_int i = 0; i < n && !rmf_loader_failed(loader); ++i) {
+        offsets[i] = rmf_loader_get_offset(loader);
+        rmf_scan_map_object(loader, nullptr, RMF_NODE_NO_PARENT, 0);
+    }
+    if (rmf_loader_failed(loader)) {
+        return;
+    }
+    offsets[n] = rmf_loader_get_offset(loader);
+
+    auto const n_workers = rmf_parallel_n_workers();
+    g_autofree RmfModelMark *marks = g_new(RmfModelMark, 2 * n);
+    g_autofree guint *workers = g_new(guint, n);
+    g_autofree RmfLoader **forks = g_new0(RmfLoader *, n_workers);
+    g_autofree rmf_int *failed_at = g_new(rmf_int, n_workers);
+    ParallelLoad load = {
+        .loader = loader,
+        .offsets = offsets,
+        .marks = marks,
+        .workers = workers,
+        .forks = forks,
+        .failed_at = failed_at,
+    };
+    rmf_parallel_for(n, PARALLEL_GRAIN, load_children_range, &load);
+
+    rmf_int n_loaded = n;
+    RmfLoader *failed = nullptr;
+    for (guint w = 0; w < n_workers; ++w) {
+        if (forks[w] == nullptr) {
+            continue;
+        }
+        loader->n_objects += forks[w]->n_objects;
+        if (rmf_loader_failed(forks[w]) && failed_at[w] < n_loaded) {
+            n_loaded = failed_at[w];
+            failed = forks[w];
+        }
+        // The fork's records and vertices now belong to this load.
+        rmf_arena_keep(
+            loader->arena,
+            rmf_arena_ref(forks[w]->arena),
+            (GDestroyNotify)rmf_arena_unref
+        );
+        if (forks[w]->scratch != nullptr) {
+            rmf_arena_keep(
+                loader->scratch,
+                rmf_arena_ref(forks[w]->scratch),
+                (GDestroyNotify)rmf_arena_unref
+            );
+        }
+    }
+
+    if (failed != nullptr) {
+        rmf_loader_abort(loader, g_error_copy(failed->error));
     } else {
-        g_warning("unknown object type '%.*s'", nstring->length, nstring->data);
-        return RMF_OBJECT_TYPE_UNKNOWN;
+        for (rmf_int i = 0; i < n; ++i) {
+            rmf_model_graft(
+                loader->model,
+                first + i,
+                forks[workers[i]]->model,
+                &marks[2 * i],
+                &marks[2 * i + 1]
+            );
+        }
+    }
+
+    for (guint w = 0; w < n_workers; ++w) {
+        g_clear_object(&forks[w]);
+    }
+}
+
+static RmfModelNode const *get_node(RmfMapObject *self)
+{
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    if (priv->model == nullptr) {
+        return &empty_node;
+    }
+    return rmf_model_node(priv->model, priv->index);
+}
+
+// Get the wrappers of the children, making them first if needed. Threads racing
+// to make them each make a set, and all but the first set are dropped.
+static GPtrArray *get_children(RmfMapObject *self)
+{
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    GPtrArray *children = g_atomic_pointer_get(&priv->children);
+    auto const node = get_node(self);
+    if (children != nullptr || node->n_children == 0) {
+        return children;
+    }
+
+    children = g_ptr_array_new_full(node->n_children, g_object_unref);
+    for (rmf_int i = 0; i < node->n_children; ++i) {
+        auto const index = node->first_child + i;
+        g_ptr_array_add(children, rmf_model_get_object(priv->model, index));
+    }
+
+    if (!g_atomic_pointer_compare_and_exchange(
+            &priv->children,
+            nullptr,
+            children
+        ))
+    {
+        g_ptr_array_unref(children);
+        children = g_atomic_pointer_get(&priv->children);
     }
+    return children;
 }
 
 // GObject /////////////////////////////////////////////////////////////////////
@@ -110,6 +267,7 @@ static void rmf_map_object_dispose(GObject *object)
         g_ptr_array_unref(priv->children);
         priv->children = nullptr;
     }
+    g_clear_pointer(&priv->model, rmf_model_unref);
     G_OBJECT_CLASS(rmf_map_object_parent_class)->dispose(object);
 }
 
@@ -121,22 +279,25 @@ static void rmf_map_object_get_property(
 )
 {
     auto const self = RMF_MAP_OBJECT(object);
-    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    auto const node = get_node(self);
     switch (property_id) {
     case PROP_OBJECT_TYPE:
-        g_value_set_enum(value, priv->object_type);
+        g_value_set_enum(value, node->object_type);
         break;
     case PROP_VISGROUP_ID:
-        g_value_set_uint(value, priv->visgroup_id);
+        g_value_set_uint(value, node->visgroup_id);
         break;
     case PROP_COLOR:
-        g_value_set_boxed(value, &priv->color);
+        g_value_set_boxed(value, &node->color);
         break;
     case PROP_N_CHILDREN:
-        g_value_set_uint(value, priv->children->len);
+        g_value_set_uint(value, node->n_children);
         break;
     case PROP_CHILDREN:
-        g_value_take_object(value, rmf_map_object_iterator_new(priv->children));
+        g_value_take_object(
+            value,
+            rmf_map_object_iterator_new(get_children(self), self)
+        );
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -146,38 +307,28 @@ static void rmf_map_object_get_property(
 
 // RmfMapObject ////////////////////////////////////////////////////////////////
 
+// Parse the object at the cursor into a model of its own, and become a view
+// onto it.
 static void rmf_map_object_load_impl(RmfMapObject *self, RmfLoader *loader)
 {
-    RmfMapObjectPrivate *priv = rmf_map_object_get_instance_private(self);
-
-    rmf_nstring type;
-    rmf_read_nstring(loader, &type);
-    priv->object_type = object_type_from_nstring(&type);
-
-    rmf_read_int(loader, &priv->visgroup_id);
-    rmf_read_color(loader, &priv->color);
-
-    rmf_int n_children;
-    rmf_read_int(loader, &n_children);
-
-    if (n_children > 0) {
-        priv->children = g_ptr_array_new_full(n_children, g_object_unref);
+    g_autoptr(RmfModel) model = rmf_loader_read_model(loader);
+    if (rmf_loader_failed(loader)) {
+        return;
+    }
 
-        rmf_loader_log_begin(
+    auto const object_type = rmf_model_node(model, 0)->object_type;
+    auto const type = rmf_object_type_get_object_gtype(object_type);
+    if (G_OBJECT_TYPE(self) != type) {
+        rmf_loader_fail(
             loader,
-            "children",
-            "count",
-            "%u",
-            n_children,
-            nullptr
+            RMF_LOADER_ERROR_INVALID,
+            "Cannot load a %s into a %s",
+            g_type_name(type),
+            G_OBJECT_TYPE_NAME(self)
         );
-        for (rmf_int i = 0; i < n_children; ++i) {
-            RmfMapObject *child = rmf_map_object_new(loader);
-            g_ptr_array_add(priv->children, child);
-        }
-        g_assert(priv->children->len == n_children);
-        rmf_loader_log_end(loader);
+        return;
     }
+    rmf_map_object_bind(self, model, 0);
 }
 
 static void rmf_map_object_class_init(RmfMapObjectClass *klass)
@@ -267,7 +418,8 @@ static void rmf_map_object_init(RmfMapObject *)
  * @map_object: The object.
  * @loader: The loader to read from.
  *
- * Reads the object's data from the loader.
+ * Reads the object's data from the loader, into a new [struct@RmfModel] of its
+ * own.
  */
 void rmf_map_object_load(RmfMapObject *self, RmfLoader *loader)
 {
@@ -288,9 +440,8 @@ void rmf_map_object_load(RmfMapObject *self, RmfLoader *loader)
  */
 RmfObjectType rmf_map_object_get_object_type(RmfMapObject *self)
 {
-    RmfObjectType value = RMF_OBJECT_TYPE_UNKNOWN;
-    g_object_get(self, "object-type", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), RMF_OBJECT_TYPE_UNKNOWN);
+    return get_node(self)->object_type;
 }
 
 /**
@@ -303,9 +454,8 @@ RmfObjectType rmf_map_object_get_object_type(RmfMapObject *self)
  */
 rmf_int rmf_map_object_get_visgroup_id(RmfMapObject *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "visgroup-id", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), 0);
+    return get_node(self)->visgroup_id;
 }
 
 /**
@@ -318,9 +468,8 @@ rmf_int rmf_map_object_get_visgroup_id(RmfMapObject *self)
  */
 RmfColor rmf_map_object_get_color(RmfMapObject *self)
 {
-    RmfColor *value = nullptr;
-    g_object_get(self, "color", &value, nullptr);
-    return *value;
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), (RmfColor){});
+    return get_node(self)->color;
 }
 
 /**
@@ -333,9 +482,8 @@ RmfColor rmf_map_object_get_color(RmfMapObject *self)
  */
 rmf_int rmf_map_object_get_n_children(RmfMapObject *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "n-children", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), 0);
+    return get_node(self)->n_children;
 }
 
 /**
@@ -348,33 +496,251 @@ rmf_int rmf_map_object_get_n_children(RmfMapObject *self)
  */
 RmfMapObjectIterator *rmf_map_object_get_children(RmfMapObject *self)
 {
-    RmfMapObjectIterator *value = nullptr;
-    g_object_get(self, "children", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), nullptr);
+    return rmf_map_object_iterator_new(get_children(self), self);
+}
+
+/**
+ * rmf_map_object_get_child_array:
+ * @map_object: The object.
+ * @n_children: (out): Return location for the number of children.
+ *
+ * Gets the children of the object as an array, without making an iterator.
+ *
+ * Returns: (transfer none) (array length=n_children) (nullable): The children,
+ * valid as long as the object.
+ */
+RmfMapObject *const *
+rmf_map_object_get_child_array(RmfMapObject *self, guint *n_children)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), nullptr);
+    g_return_val_if_fail(n_children != nullptr, nullptr);
+    auto const children = get_children(self);
+    return (RmfMapObject *const *)rmf_ptr_array_span(children, n_children);
+}
+
+/**
+ * rmf_map_object_get_model:
+ * @map_object: The object.
+ *
+ * Gets the model holding the object's node.
+ *
+ * Returns: (transfer none) (nullable): The model, or `NULL` if the object was
+ * never loaded.
+ */
+RmfModel *rmf_map_object_get_model(RmfMapObject *self)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), nullptr);
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    return priv->model;
+}
+
+/**
+ * rmf_map_object_get_index:
+ * @map_object: The object.
+ *
+ * Gets the index of the object's node in its model.
+ *
+ * Returns: The node index.
+ */
+rmf_int rmf_map_object_get_index(RmfMapObject *self)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), 0);
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    return priv->index;
+}
+
+/**
+ * rmf_map_object_get_parent:
+ * @map_object: The object.
+ *
+ * Makes a [class@RmfMapObject] for the object's parent. Each call makes a new
+ * one.
+ *
+ * Returns: (transfer full) (nullable): The parent, or `NULL` if the object is
+ * the root of its model or was never loaded.
+ */
+RmfMapObject *rmf_map_object_get_parent(RmfMapObject *self)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), nullptr);
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    if (priv->model == nullptr || priv->model->preorder->len == 0) {
+        return nullptr;
+    }
+    auto const entries
+        = (RmfModelPreorderEntry const *)priv->model->preorder->data;
+    auto const position
+        = g_array_index(priv->model->positions, rmf_int, priv->index);
+    auto const parent = entries[position].parent;
+    if (parent == RMF_MODEL_NO_PARENT) {
+        return nullptr;
+    }
+    return rmf_model_get_object(priv->model, entries[parent].node);
+}
+
+/**
+ * rmf_map_object_get_depth:
+ * @map_object: The object.
+ *
+ * Gets the number of ancestors of the object in its model.
+ *
+ * Returns: The depth.
+ */
+rmf_int rmf_map_object_get_depth(RmfMapObject *self)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), 0);
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    if (priv->model == nullptr || priv->model->preorder->len == 0) {
+        return 0;
+    }
+    auto const entries
+        = (RmfModelPreorderEntry const *)priv->model->preorder->data;
+    auto const position
+        = g_array_index(priv->model->positions, rmf_int, priv->index);
+    return entries[position].depth;
+}
+
+/**
+ * rmf_map_object_get_bounds:
+ * @map_object: The object.
+ *
+ * Gets the axis-aligned bounds of the object. For a solid, these are the
+ * bounds of its vertices, and for other objects the bounds of the solids
+ * under them. They are worked out once, while loading.
+ *
+ * Returns: (transfer none) (nullable): The bounds, or `NULL` if the object was
+ * never loaded. Objects without solids have empty bounds.
+ */
+RmfBounds const *rmf_map_object_get_bounds(RmfMapObject *self)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), nullptr);
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    if (priv->model == nullptr || priv->model->bounds->len == 0) {
+        return nullptr;
+    }
+    return &g_array_index(priv->model->bounds, RmfBounds, priv->index);
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-RmfMapObject *rmf_map_object_new(RmfLoader *loader)
+RmfObjectType rmf_object_type_from_nstring(rmf_nstring const *nstring)
 {
+    if (g_str_equal(nstring->data, "CMapWorld")) {
+        return RMF_OBJECT_TYPE_WORLD;
+    } else if (g_str_equal(nstring->data, "CMapSolid")) {
+        return RMF_OBJECT_TYPE_SOLID;
+    } else if (g_str_equal(nstring->data, "CMapEntity")) {
+        return RMF_OBJECT_TYPE_ENTITY;
+    } else if (g_str_equal(nstring->data, "CMapGroup")) {
+        return RMF_OBJECT_TYPE_GROUP;
+    } else {
+        return RMF_OBJECT_TYPE_UNKNOWN;
+    }
+}
+
+// Parse the map object at the cursor into node @index of the loader's model.
+void rmf_read_map_object(RmfLoader *loader, rmf_int index)
+{
+    rmf_loader_tick(loader);
+    auto const model = loader->model;
+
     // Peek the object type.
     rmf_nstring type_str;
     rmf_read_nstring(loader, &type_str);
     rmf_loader_seek(loader, -(1 + type_str.length));
-    auto const object_type = object_type_from_nstring(&type_str);
+    if (rmf_loader_failed(loader)) {
+        return;
+    }
+    auto const object_type = rmf_object_type_from_nstring(&type_str);
 
-    // Construct the proper subclass according to the object type.
     switch (object_type) {
     case RMF_OBJECT_TYPE_WORLD:
-        return RMF_MAP_OBJECT(rmf_worldspawn_new(loader));
+        RMF_TRACE_BEGIN(loader, "worldspawn", nullptr);
+        break;
     case RMF_OBJECT_TYPE_SOLID:
-        return RMF_MAP_OBJECT(rmf_solid_new(loader));
+        RMF_TRACE_BEGIN(loader, "solid", nullptr);
+        break;
     case RMF_OBJECT_TYPE_ENTITY:
-        return RMF_MAP_OBJECT(rmf_entity_new(loader));
+        RMF_TRACE_BEGIN(loader, "entity", nullptr);
+        break;
     case RMF_OBJECT_TYPE_GROUP:
-        return RMF_MAP_OBJECT(rmf_group_new(loader));
+        break;
     case RMF_OBJECT_TYPE_UNKNOWN:
+        rmf_loader_fail(
+            loader,
+            RMF_LOADER_ERROR_INVALID,
+            "Unknown object type '%s'",
+            type_str.data
+        );
+        return;
+    }
+
+    RmfModelNode node = {.object_type = object_type};
+    rmf_loader_seek(loader, 1 + type_str.length);
+    rmf_read_int(loader, &node.visgroup_id);
+    rmf_read_color(loader, &node.color);
+    rmf_read_count(loader, &node.n_children, 1);
+    node.first_child = rmf_model_add_nodes(model, node.n_children);
+    *rmf_model_node(model, index) = node;
+
+    if (node.n_children > 0) {
+        RMF_TRACE_BEGIN(loader, "children", "count=\"%u\"", node.n_children);
+        if (object_type == RMF_OBJECT_TYPE_WORLD
+            && node.n_children >= PARALLEL_MIN_CHILDREN
+            && (loader->flags & RMF_LOADER_FLAGS_PARALLEL)
+            && !RMF_TRACE_ENABLED(loader))
+        {
+            load_children_parallel(loader, node.first_child, node.n_children);
+        } else {
+            for (rmf_int i = 0;
+                 i < node.n_children && !rmf_loader_failed(loader);
+                 ++i)
+            {
+                rmf_read_map_object(loader, node.first_child + i);
+            }
+        }
+        RMF_TRACE_END(loader);
+    }
+
+    rmf_int payload = 0;
+    switch (object_type) {
+    case RMF_OBJECT_TYPE_WORLD:
+        payload = rmf_worldspawn_read(loader);
+        break;
+    case RMF_OBJECT_TYPE_SOLID:
+        payload = rmf_solid_read(loader);
+        break;
+    case RMF_OBJECT_TYPE_ENTITY:
+        payload = rmf_entity_read(loader);
         break;
+    case RMF_OBJECT_TYPE_GROUP:
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+    // The node may have moved while its children were added.
+    rmf_model_node(model, index)->payload = payload;
+
+    if (object_type != RMF_OBJECT_TYPE_GROUP) {
+        RMF_TRACE_END(loader);
     }
-    g_return_val_if_reached(nullptr);
+}
+
+// Make @self a view onto node @index of @model.
+void rmf_map_object_bind(RmfMapObject *self, RmfModel *model, rmf_int index)
+{
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    g_clear_pointer(&priv->children, g_ptr_array_unref);
+    g_clear_pointer(&priv->model, rmf_model_unref);
+    priv->model = rmf_model_ref(model);
+    priv->index = index;
+}
+
+// Get the node of @self, and the model holding it, or `nullptr` if @self was
+// never loaded. The node is then empty.
+RmfModelNode const *
+rmf_map_object_peek_node(RmfMapObject *self, RmfModel **model)
+{
+    RmfMapObjectPrivate *const priv = rmf_map_object_get_instance_private(self);
+    *model = priv->model;
+    return get_node(self);
 }
@@ -12,6 +12,7 @@
 G_BEGIN_DECLS
 
 typedef struct _RmfMapObject RmfMapObject;
+typedef struct _RmfModel RmfModel;
 
 // RmfObjectType
 
@@ -64,6 +65,13 @@ rmf_int rmf_map_object_get_visgroup_id(RmfMapObject *map_object);
 RmfColor rmf_map_object_get_color(RmfMapObject *map_object);
 rmf_int rmf_map_object_get_n_children(RmfMapObject *map_object);
 RmfMapObjectIterator *rmf_map_object_get_children(RmfMapObject *map_object);
+RmfMapObject *const *
+rmf_map_object_get_child_array(RmfMapObject *map_object, guint *n_children);
+RmfModel *rmf_map_object_get_model(RmfMapObject *map_object);
+rmf_int rmf_map_object_get_index(RmfMapObject *map_object);
+RmfMapObject *rmf_map_object_get_parent(RmfMapObject *map_object);
+rmf_int rmf_map_object_get_depth(RmfMapObject *map_object);
+RmfBounds const *rmf_map_object_get_bounds(RmfMapObject *map_object);
 
 G_END_DECLS
 
@@ -0,0 +1,428 @@
+#include "rmf/rmf-model.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfModelNode:
+ * @object_type: The [enum@RmfObjectType] of the map object.
+ * @color: Editor color of the object.
+ * @visgroup_id: ID of the visgroup the object belongs to.
+ * @first_child: Index of the object's first child in the node table. The
+ *   children of a node always follow each other.
+ * @n_children: Number of children of the object.
+ * @payload: Index of the object's type-specific data. For solids, this is also
+ *   the solid's index in the [struct@RmfGeometry] of the map, if any.
+ *
+ * One map object in the node table of an [struct@RmfModel].
+ */
+
+/**
+ * RMF_MODEL_NO_PARENT:
+ *
+ * The @parent of the root's [struct@RmfModelPreorderEntry].
+ */
+
+/**
+ * RmfModelPreorderEntry:
+ * @node: Index of the node in the node table.
+ * @parent: Preorder position of the node's parent, or [const@MODEL_NO_PARENT]
+ *   for the root.
+ * @depth: Number of ancestors of the node.
+ * @end: Preorder position just past the node's last descendant. The node's
+ *   descendants are the entries between its own position and @end.
+ *
+ * One map object in the preorder table of an [struct@RmfModel].
+ */
+
+/**
+ * RmfModel:
+ *
+ * The map objects of a load, as a compact table of [struct@RmfModelNode]s.
+ *
+ * The loader fills the table directly. [class@RmfMapObject]s are only made
+ * when asked for, as views onto a node which keep the model alive. Code which
+ * processes whole maps can walk the table instead, starting from the root at
+ * index 0.
+ *
+ * The model also has a preorder table listing the nodes depth-first, so that
+ * the descendants of any node follow it in one run, and parents and depths
+ * can be looked up directly, and the bounds of every node.
+ *
+ * Get the model of a map with [method@RmfRoot.get_model].
+ */
+G_DEFINE_BOXED_TYPE(RmfModel, rmf_model, rmf_model_ref, rmf_model_unref)
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static void model_clear(RmfModel *self)
+{
+    for (guint i = 0; i < self->solids->len; ++i) {
+        auto const solid = rmf_model_solid(self, i);
+        g_clear_pointer(&solid->faces, g_ptr_array_unref);
+    }
+    for (guint i = 0; i < self->entities->len; ++i) {
+        auto const entity = rmf_model_entity(self, i);
+        g_clear_pointer(&entity->keyvalues, g_ptr_array_unref);
+        g_clear_pointer(&entity->paths, g_ptr_array_unref);
+    }
+    g_array_unref(self->nodes);
+    g_array_unref(self->solids);
+    g_array_unref(self->entities);
+    g_array_unref(self->preorder);
+    g_array_unref(self->positions);
+    g_array_unref(self->bounds);
+    g_clear_pointer(&self->arena, rmf_arena_unref);
+    g_clear_pointer(&self->data, g_bytes_unref);
+    g_clear_pointer(&self->strings, rmf_string_pool_unref);
+}
+
+static void rebase_node(
+    RmfModelNode *node,
+    rmf_int node_delta,
+    rmf_int solid_delta,
+    rmf_int entity_delta
+)
+{
+    // Unsigned wraparound makes negative deltas work out.
+    node->first_child += node_delta;
+    switch ((RmfObjectType)node->object_type) {
+    case RMF_OBJECT_TYPE_SOLID:
+        node->payload += solid_delta;
+        break;
+    case RMF_OBJECT_TYPE_WORLD:
+    case RMF_OBJECT_TYPE_ENTITY:
+        node->payload += entity_delta;
+        break;
+    case RMF_OBJECT_TYPE_GROUP:
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_model_ref:
+ * @model: The model.
+ *
+ * Increases the reference count of a model.
+ *
+ * Returns: (transfer full): The model.
+ */
+RmfModel *rmf_model_ref(RmfModel *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_model_unref:
+ * @model: (transfer full): The model.
+ *
+ * Decreases the reference count of a model, freeing it and all of its records
+ * when it reaches zero.
+ */
+void rmf_model_unref(RmfModel *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)model_clear);
+}
+
+/**
+ * rmf_model_get_nodes:
+ * @model: The model.
+ * @n_nodes: (out): Return location for the number of nodes.
+ *
+ * Gets the node table of the model.
+ *
+ * Returns: (transfer none) (array length=n_nodes): The nodes.
+ */
+RmfModelNode const *rmf_model_get_nodes(RmfModel *self, guint *n_nodes)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_nodes != nullptr, nullptr);
+    *n_nodes = self->nodes->len;
+    return (RmfModelNode const *)self->nodes->data;
+}
+
+/**
+ * rmf_model_get_object:
+ * @model: The model.
+ * @index: Index of a node in the model.
+ *
+ * Makes a [class@RmfMapObject] for a node. Each call makes a new one.
+ *
+ * Returns: (transfer full): The map object.
+ */
+RmfMapObject *rmf_model_get_object(RmfModel *self, rmf_int index)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(index < self->nodes->len, nullptr);
+
+    auto const node = rmf_model_node(self, index);
+    auto const type = rmf_object_type_get_object_gtype(node->object_type);
+    g_return_val_if_fail(type != G_TYPE_INVALID, nullptr);
+
+    RmfMapObject *object = g_object_new(type, nullptr);
+    rmf_map_object_bind(object, self, index);
+    return object;
+}
+
+/**
+ * rmf_model_get_preorder:
+ * @model: The model.
+ * @n_entries: (out): Return location for the number of entries.
+ *
+ * Gets the preorder table of the model, with one entry for each node. The
+ * table is empty if the load that made the model failed.
+ *
+ * Returns: (transfer none) (array length=n_entries): The entries.
+ */
+RmfModelPreorderEntry const *
+rmf_model_get_preorder(RmfModel *self, guint *n_entries)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_entries != nullptr, nullptr);
+    *n_entries = self->preorder->len;
+    return (RmfModelPreorderEntry const *)self->preorder->data;
+}
+
+/**
+ * rmf_model_get_preorder_position:
+ * @model: The model.
+ * @index: Index of a node in the model.
+ *
+ * Gets the position of a node in the preorder table of the model.
+ *
+ * Returns: The position.
+ */
+rmf_int rmf_model_get_preorder_position(RmfModel *self, rmf_int index)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_return_val_if_fail(index < self->positions->len, 0);
+    return g_array_index(self->positions, rmf_int, index);
+}
+
+/**
+ * rmf_model_get_bounds:
+ * @model: The model.
+ * @n_bounds: (out): Return location for the number of bounds.
+ *
+ * Gets the bounds of each node of the model, in node table order. The bounds
+ * of a solid are those of its vertices, and the bounds of any other object
+ * are those of the solids under it. The table is empty if the load that made
+ * the model failed.
+ *
+ * Returns: (transfer none) (array length=n_bounds): The bounds.
+ */
+RmfBounds const *rmf_model_get_bounds(RmfModel *self, guint *n_bounds)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_bounds != nullptr, nullptr);
+    *n_bounds = self->bounds->len;
+    return (RmfBounds const *)self->bounds->data;
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Make an empty model for the records of @loader's current load.
+RmfModel *rmf_model_new(RmfLoader *loader)
+{
+    RmfModel *self = g_atomic_rc_box_new0(RmfModel);
+    self->nodes = g_array_new(FALSE, TRUE, sizeof(RmfModelNode));
+    self->solids = g_array_new(FALSE, TRUE, sizeof(RmfSolidRecord));
+    self->entities = g_array_new(FALSE, TRUE, sizeof(RmfEntityRecord));
+    self->preorder = g_array_new(FALSE, FALSE, sizeof(RmfModelPreorderEntry));
+    self->positions = g_array_new(FALSE, FALSE, sizeof(rmf_int));
+    self->bounds = g_array_new(FALSE, FALSE, sizeof(RmfBounds));
+    if (loader->arena != nullptr) {
+        self->arena = rmf_arena_ref(loader->arena);
+    }
+    if (loader->flags & RMF_LOADER_FLAGS_LAZY_FACES) {
+        self->data = g_bytes_ref(loader->data);
+        self->readers = loader->readers;
+        self->strings = rmf_string_pool_ref(loader->strings);
+    }
+    return self;
+}
+
+// Append @n zeroed nodes, returning the index of the first.
+rmf_int rmf_model_add_nodes(RmfModel *self, rmf_int n)
+{
+    auto const first = self->nodes->len;
+    g_array_set_size(self->nodes, first + n);
+    return first;
+}
+
+void rmf_model_mark(RmfModel const *self, RmfModelMark *mark)
+{
+    *mark = (RmfModelMark){
+        .nodes = self->nodes->len,
+        .solids = self->solids->len,
+        .entities = self->entities->len,
+    };
+}
+
+// Move a subtree parsed into @from to node @index of @self. The subtree's root
+// is node @begin->nodes of @from, and its records are those between @begin and
+// @end. Its descendants are appended to @self.
+void rmf_model_graft(
+    RmfModel *self,
+    rmf_int index,
+    RmfModel *from,
+    RmfModelMark const *begin,
+    RmfModelMark const *end
+)
+{
+    auto const n_nodes = end->nodes - begin->nodes - 1;
+    auto const n_solids = end->solids - begin->solids;
+    auto const n_entities = end->entities - begin->entities;
+
+    auto const first_node = self->nodes->len;
+    auto const node_delta = first_node - (begin->nodes + 1);
+    auto const solid_delta = self->solids->len - begin->solids;
+    auto const entity_delta = self->entities->len - begin->entities;
+
+    g_array_append_vals(
+        self->nodes,
+        rmf_model_node(from, begin->nodes + 1),
+        n_nodes
+    );
+    g_array_append_vals(
+        self->solids,
+        rmf_model_solid(from, begin->solids),
+        n_solids
+    );
+    g_array_append_vals(
+        self->entities,
+        rmf_model_entity(from, begin->entities),
+        n_entities
+    );
+
+    // The records now belong to @self.
+    memset(
+        rmf_model_solid(from, begin->solids),
+        0,
+        n_solids * sizeof(RmfSolidRecord)
+    );
+    memset(
+        rmf_model_entity(from, begin->entities),
+        0,
+        n_entities * sizeof(RmfEntityRecord)
+    );
+
+    auto const root = rmf_model_node(self, index);
+    *root = *rmf_model_node(from, begin->nodes);
+    rebase_node(root, node_delta, solid_delta, entity_delta);
+    for (rmf_int i = first_node; i < self->nodes->len; ++i) {
+        auto const node = rmf_model_node(self, i);
+        rebase_node(node, node_delta, solid_delta, entity_delta);
+    }
+}
+
+// Fill the preorder table of a complete model. Children always come after
+// their parent in the node table, so subtree sizes can be summed up in reverse
+// and positions handed out going forward, without walking the tree.
+void rmf_model_build_preorder(RmfModel *self)
+{
+    auto const n = self->nodes->len;
+    g_array_set_size(self->preorder, n);
+    g_array_set_size(self->positions, n);
+    if (n == 0) {
+        return;
+    }
+    auto const entries = (RmfModelPreorderEntry *)self->preorder->data;
+    auto const positions = (rmf_int *)self->positions->data;
+
+    // Borrow the positions for the subtree sizes.
+    for (rmf_int i = n; i-- > 0;) {
+        auto const node = rmf_model_node(self, i);
+        rmf_int size = 1;
+        for (rmf_int j = 0; j < node->n_children; ++j) {
+            size += positions[node->first_child + j];
+        }
+        positions[i] = size;
+    }
+
+    entries[0] = (RmfModelPreorderEntry){
+        .node = 0,
+        .parent = RMF_MODEL_NO_PARENT,
+        .depth = 0,
+        .end = positions[0],
+    };
+    positions[0] = 0;
+    for (rmf_int i = 0; i < n; ++i) {
+        auto const node = rmf_model_node(self, i);
+        auto const parent = positions[i];
+        auto position = parent + 1;
+        for (rmf_int j = 0; j < node->n_children; ++j) {
+            auto const child = node->first_child + j;
+            auto const size = positions[child];
+            entries[position] = (RmfModelPreorderEntry){
+                .node = child,
+                .parent = parent,
+                .depth = entries[parent].depth + 1,
+                .end = position + size,
+            };
+            positions[child] = position;
+            position += size;
+        }
+    }
+}
+
+// Fill in the bounds of every node of a complete model, from the solids up.
+// Children always come after their parent, so one reverse pass will do.
+void rmf_model_build_bounds(RmfModel *self)
+{
+    auto const n = self->nodes->len;
+    g_array_set_size(self->bounds, n);
+    auto const bounds = (RmfBounds *)self->bounds->data;
+    for (rmf_int i = n; i-- > 0;) {
+        auto const node = rmf_model_node(self, i);
+        if (node->object_type == RMF_OBJECT_TYPE_SOLID) {
+            bounds[i] = rmf_model_solid(self, node->payload)->bounds;
+            continue;
+        }
+        rmf_bounds_clear(&bounds[i]);
+        for (rmf_int j = 0; j < node->n_children; ++j) {
+            rmf_bounds_union(&bounds[i], &bounds[node->first_child + j]);
+        }
+    }
+}
+
+// Get the faces of the solid at node @index, decoding them if they were loaded
+// lazily.
+GPtrArray *rmf_model_get_solid_faces(RmfModel *self, rmf_int index)
+{
+    auto const record
+        = rmf_model_solid(self, rmf_model_node(self, index)->payload);
+    GPtrArray *faces = g_atomic_pointer_get(&record->faces);
+    if (faces == nullptr && self->data != nullptr) {
+        g_autoptr(RmfMapObject) solid = rmf_model_get_object(self, index);
+        guint n_faces;
+        rmf_solid_get_face_array(RMF_SOLID(solid), &n_faces);
+        faces = g_atomic_pointer_get(&record->faces);
+    }
+    return faces;
+}
+
+// Get the class of map objects of type @object_type.
+GType rmf_object_type_get_object_gtype(RmfObjectType object_type)
+{
+    switch (object_type) {
+    case RMF_OBJECT_TYPE_WORLD:
+        return RMF_TYPE_WORLDSPAWN;
+    case RMF_OBJECT_TYPE_SOLID:
+        return RMF_TYPE_SOLID;
+    case RMF_OBJECT_TYPE_ENTITY:
+        return RMF_TYPE_ENTITY;
+    case RMF_OBJECT_TYPE_GROUP:
+        return RMF_TYPE_GROUP;
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+    return G_TYPE_INVALID;
+}
@@ -0,0 +1,57 @@
+#ifndef RMF_MODEL_H
+#define RMF_MODEL_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-mapobject.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfModelNode
+
+typedef struct {
+    rmf_byte object_type;
+    RmfColor color;
+    rmf_int visgroup_id;
+    rmf_int first_child;
+    rmf_int n_children;
+    rmf_int payload;
+} RmfModelNode;
+
+// RmfModelPreorderEntry
+
+#define RMF_MODEL_NO_PARENT G_MAXUINT32
+
+typedef struct {
+    rmf_int node;
+    rmf_int parent;
+    rmf_int depth;
+    rmf_int end;
+} RmfModelPreorderEntry;
+
+// RmfModel
+
+#define RMF_TYPE_MODEL rmf_model_get_type()
+
+typedef struct _RmfModel RmfModel;
+
+GType rmf_model_get_type(void);
+RmfModel *rmf_model_ref(RmfModel *model);
+void rmf_model_unref(RmfModel *model);
+RmfModelNode const *rmf_model_get_nodes(RmfModel *model, guint *n_nodes);
+RmfMapObject *rmf_model_get_object(RmfModel *model, rmf_int index);
+RmfModelPreorderEntry const *
+rmf_model_get_preorder(RmfModel *model, guint *n_entries);
+rmf_int rmf_model_get_preorder_position(RmfModel *model, rmf_int index);
+RmfBounds const *rmf_model_get_bounds(RmfModel *model, guint *n_bounds);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfModel, rmf_model_unref)
+
+G_END_DECLS
+
+#endif
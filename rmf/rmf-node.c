@@ -0,0 +1,98 @@
+#include "rmf/rmf-node.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfNode:
+ * @object_type: Type of the map object.
+ * @parent: Index of the parent node in the table, or [const@NODE_NO_PARENT].
+ * @depth: Number of ancestors of the object.
+ * @offset: Byte offset of the object's record in the data.
+ * @length: Length of the object's record in bytes, including its children.
+ *
+ * The location of one map object in RMF data, as found by
+ * [method@RmfLoader.scan_file].
+ */
+G_DEFINE_BOXED_TYPE(RmfNode, rmf_node, rmf_node_copy, rmf_node_free)
+
+RmfNode *rmf_node_copy(RmfNode const *self)
+{
+    auto const copy = g_new(RmfNode, 1);
+    memcpy(copy, self, sizeof(RmfNode));
+    return copy;
+}
+
+void rmf_node_free(RmfNode *self)
+{
+    g_free(self);
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Append a node for the map object at the cursor, then for each of its
+// descendants in file order. Only counts are read; everything else is skipped.
+// With no @nodes, the object is only skipped.
+void rmf_scan_map_object(
+    RmfLoader *loader,
+    GArray *nodes,
+    rmf_int parent,
+    rmf_int depth
+)
+{
+    auto const offset = rmf_loader_get_offset(loader);
+
+    rmf_nstring type;
+    rmf_read_nstring(loader, &type);
+    rmf_loader_seek(loader, sizeof(rmf_int) + sizeof(RmfColor));
+    rmf_int n_children = 0;
+    rmf_read_count(loader, &n_children, 1);
+    if (rmf_loader_failed(loader)) {
+        return;
+    }
+
+    auto const object_type = rmf_object_type_from_nstring(&type);
+    rmf_int const index = nodes ? nodes->len : RMF_NODE_NO_PARENT;
+    if (nodes != nullptr) {
+        RmfNode const node = {
+            .object_type = object_type,
+            .parent = parent,
+            .depth = depth,
+            .offset = offset,
+        };
+        g_array_append_val(nodes, node);
+    }
+
+    for (rmf_int i = 0; i < n_children && !rmf_loader_failed(loader); ++i) {
+        rmf_scan_map_object(loader, nodes, index, depth + 1);
+    }
+
+    switch (object_type) {
+    case RMF_OBJECT_TYPE_WORLD:
+        rmf_worldspawn_skip(loader);
+        break;
+    case RMF_OBJECT_TYPE_SOLID:
+        rmf_solid_skip(loader);
+        break;
+    case RMF_OBJECT_TYPE_ENTITY:
+        rmf_entity_skip(loader);
+        break;
+    case RMF_OBJECT_TYPE_GROUP:
+        break;
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        rmf_loader_fail(
+            loader,
+            RMF_LOADER_ERROR_INVALID,
+            "Unknown object type '%s'",
+            type.data
+        );
+        return;
+    }
+
+    if (nodes != nullptr) {
+        g_array_index(nodes, RmfNode, index).length
+            = rmf_loader_get_offset(loader) - offset;
+    }
+}
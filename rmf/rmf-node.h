@@ -0,0 +1,40 @@
+#ifndef RMF_NODE_H
+#define RMF_NODE_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-mapobject.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfNode
+
+#define RMF_TYPE_NODE rmf_node_get_type()
+
+/**
+ * RMF_NODE_NO_PARENT:
+ *
+ * Parent index of the root node of a table of [struct@RmfNode]s.
+ */
+#define RMF_NODE_NO_PARENT G_MAXUINT32
+
+struct _RmfNode {
+    RmfObjectType object_type;
+    rmf_int parent;
+    rmf_int depth;
+    goffset offset;
+    goffset length;
+};
+
+GType rmf_node_get_type(void);
+RmfNode *rmf_node_copy(RmfNode const *self);
+void rmf_node_free(RmfNode *self);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,530 @@
+#include "rmf/rmf-overlap.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * RmfNodePair:
+ * @first: Index of a node in the model.
+ * @second: Index of another node in the model, above @first.
+ *
+ * Two solids which overlap, with @first < @second, as found by
+ * [method@RmfBvh.find_overlapping_solids].
+ */
+
+/**
+ * RmfFacePair:
+ * @first_node: Index of a solid's node in the model.
+ * @first_face: Index of a face of the first solid.
+ * @second_node: Index of another solid's node in the model, above
+ *   @first_node.
+ * @second_face: Index of a face of the second solid.
+ *
+ * Two coplanar faces of different solids which overlap, as found by
+ * [method@RmfBvh.find_coplanar_faces].
+ */
+
+// Candidate pairs per chunk of the narrow phase.
+#define PAIR_GRAIN 256
+
+typedef struct {
+    RmfBvhHulls const *hulls;
+    rmf_float tolerance;
+    RmfNodePair const *pairs; // Objects of the BVH, not model nodes.
+    guint8 *overlapping;
+} NarrowPhase;
+
+// Most each component of two normals may differ by for their faces to count
+// as coplanar. The normals of faces meant to be coplanar come from the same
+// grid-snapped points and match far more closely.
+#define NORMAL_EPSILON (1.0f / 4096)
+
+// A face, keyed by the group of planes it is in.
+typedef struct {
+    rmf_int group;  // The root of its plane in the PlaneGroups.
+    rmf_int object; // In the BVH.
+    rmf_int plane;  // In the hulls.
+} FaceKey;
+
+// The distinct planes of the faces, joined into groups where one is within the
+// epsilons of another, so that every pair of faces which may be coplanar is in
+// one group.
+typedef struct {
+    RmfPlaneHash hash;
+    GArray *parents;        // Array<rmf_int>, a union-find forest.
+    RmfPlane const *adding; // The plane being added.
+    GArray *nearby;         // Array<rmf_int>, the planes near it.
+    rmf_int same;           // A plane equal to it, if any.
+} PlaneGroups;
+
+// A face projected onto the plane it shares with others.
+typedef struct {
+    rmf_float min_u;
+    rmf_float max_u;
+    rmf_float min_v;
+    rmf_float max_v;
+    rmf_int key; // In the array of FaceKeys.
+} FaceSpan;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static int compare_min_x(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    RmfBounds const *bounds = user_data;
+    auto const ax = bounds[*(rmf_int const *)a].min.x;
+    auto const bx = bounds[*(rmf_int const *)b].min.x;
+    return (ax > bx) - (ax < bx);
+}
+
+static int compare_pairs(gconstpointer a, gconstpointer b)
+{
+    RmfNodePair const *pa = a;
+    RmfNodePair const *pb = b;
+    if (pa->first != pb->first) {
+        return pa->first < pb->first ? -1 : 1;
+    }
+    return (pa->second > pb->second) - (pa->second < pb->second);
+}
+
+// Whether one of the planes of object @a has all the vertices of object @b in
+// front of it, or at most @tolerance behind it, so that @b reaches no more
+// than @tolerance into @a. The loop over the vertices has no branches, so it
+// is vectorised.
+static bool planes_separate(
+    RmfBvhHulls const *hulls,
+    rmf_int a,
+    rmf_int b,
+    rmf_float tolerance
+)
+{
+    auto const first_vertex = hulls->first_vertex[b];
+    auto const end_vertex = hulls->first_vertex[b + 1];
+    for (rmf_int i = hulls->first[a]; i < hulls->first[a + 1]; ++i) {
+        auto const nx = hulls->nx[i];
+        auto const ny = hulls->ny[i];
+        auto const nz = hulls->nz[i];
+        auto lowest = G_MAXFLOAT;
+        for (rmf_int v = first_vertex; v < end_vertex; ++v) {
+            auto const height
+                = nx * hulls->vx[v] + ny * hulls->vy[v] + nz * hulls->vz[v];
+            lowest = height < lowest ? height : lowest;
+        }
+        if (lowest - hulls->d[i] >= -tolerance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void narrow_phase(guint begin, guint end, guint, gpointer user_data)
+{
+    NarrowPhase const *phase = user_data;
+    for (guint i = begin; i < end; ++i) {
+        auto const pair = &phase->pairs[i];
+        auto const a = pair->first;
+        auto const b = pair->second;
+        phase->overlapping[i]
+            = !planes_separate(phase->hulls, a, b, phase->tolerance)
+           && !planes_separate(phase->hulls, b, a, phase->tolerance);
+    }
+}
+
+static int compare_face_keys(gconstpointer a, gconstpointer b)
+{
+    FaceKey const *ka = a;
+    FaceKey const *kb = b;
+    if (ka->group != kb->group) {
+        return ka->group < kb->group ? -1 : 1;
+    }
+    return (ka->plane > kb->plane) - (ka->plane < kb->plane);
+}
+
+static int compare_face_spans(gconstpointer a, gconstpointer b)
+{
+    FaceSpan const *sa = a;
+    FaceSpan const *sb = b;
+    return (sa->min_u > sb->min_u) - (sa->min_u < sb->min_u);
+}
+
+static int compare_face_pairs(gconstpointer a, gconstpointer b)
+{
+    RmfFacePair const *pa = a;
+    RmfFacePair const *pb = b;
+    if (pa->first_node != pb->first_node) {
+        return pa->first_node < pb->first_node ? -1 : 1;
+    }
+    if (pa->second_node != pb->second_node) {
+        return pa->second_node < pb->second_node ? -1 : 1;
+    }
+    if (pa->first_face != pb->first_face) {
+        return pa->first_face < pb->first_face ? -1 : 1;
+    }
+    return (pa->second_face > pb->second_face)
+         - (pa->second_face < pb->second_face);
+}
+
+// The two axes a plane with normal @n is projected onto: those other than the
+// one it faces most along.
+static void project_axes(RmfVector const *n, guint *u, guint *v)
+{
+    auto const ax = fabsf(n->x);
+    auto const ay = fabsf(n->y);
+    auto const az = fabsf(n->z);
+    if (ax >= ay && ax >= az) {
+        *u = 1;
+        *v = 2;
+    } else if (ay >= az) {
+        *u = 0;
+        *v = 2;
+    } else {
+        *u = 0;
+        *v = 1;
+    }
+}
+
+static rmf_float vertex_axis(RmfBvhHulls const *hulls, rmf_int v, guint axis)
+{
+    return axis == 0 ? hulls->vx[v] : axis == 1 ? hulls->vy[v] : hulls->vz[v];
+}
+
+// Whether an edge of the polygon of plane @a, projected onto axes @u and @v,
+// separates it from the polygon of plane @b.
+static bool edges_separate(
+    RmfBvhHulls const *hulls,
+    rmf_int a,
+    rmf_int b,
+    guint u,
+    guint v,
+    rmf_float tolerance
+)
+{
+    auto const first = hulls->plane_vertex[a];
+    auto const end = hulls->plane_vertex[a + 1];
+    for (rmf_int i = first; i < end; ++i) {
+        auto const j = i + 1 < end ? i + 1 : first;
+        auto const eu = vertex_axis(hulls, j, u) - vertex_axis(hulls, i, u);
+        auto const ev = vertex_axis(hulls, j, v) - vertex_axis(hulls, i, v);
+        auto const length = sqrtf(eu * eu + ev * ev);
+        if (!(length > 0.0f)) {
+            continue;
+        }
+        // Project both polygons onto the edge's normal.
+        auto const nu = -ev / length;
+        auto const nv = eu / length;
+        rmf_float min_a = G_MAXFLOAT, max_a = -G_MAXFLOAT;
+        for (auto k = first; k < end; ++k) {
+            auto const p = nu * vertex_axis(hulls, k, u)
+                         + nv * vertex_axis(hulls, k, v);
+            min_a = MIN(min_a, p);
+            max_a = MAX(max_a, p);
+        }
+        rmf_float min_b = G_MAXFLOAT, max_b = -G_MAXFLOAT;
+        for (auto k = hulls->plane_vertex[b]; k < hulls->plane_vertex[b + 1];
+             ++k)
+        {
+            auto const p = nu * vertex_axis(hulls, k, u)
+                         + nv * vertex_axis(hulls, k, v);
+            min_b = MIN(min_b, p);
+            max_b = MAX(max_b, p);
+        }
+        if (max_a <= min_b + tolerance || max_b <= min_a + tolerance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static RmfPlane hull_plane(RmfBvhHulls const *hulls, rmf_int plane)
+{
+    return (RmfPlane){
+        {hulls->nx[plane], hulls->ny[plane], hulls->nz[plane]},
+        hulls->d[plane],
+    };
+}
+
+static rmf_int find_group(GArray *parents, rmf_int plane)
+{
+    auto const p = (rmf_int *)parents->data;
+    while (p[plane] != plane) {
+        p[plane] = p[p[plane]];
+        plane = p[plane];
+    }
+    return plane;
+}
+
+static bool note_near_plane(rmf_int index, gpointer user_data)
+{
+    PlaneGroups *groups = user_data;
+    auto const plane = &g_array_index(groups->hash.planes, RmfPlane, index);
+    if (memcmp(plane, groups->adding, sizeof(RmfPlane)) == 0) {
+        groups->same = index;
+        return false;
+    }
+    g_array_append_val(groups->nearby, index);
+    return true;
+}
+
+// Add @plane to @groups, joining its group with those of the planes near it,
+// and return its index. A plane equal to one added before gets that one's
+// index, so the many faces of a large flat area are only grouped once.
+static rmf_int add_to_groups(PlaneGroups *groups, RmfPlane const *plane)
+{
+    groups->adding = plane;
+    groups->same = G_MAXUINT32;
+    g_array_set_size(groups->nearby, 0);
+    rmf_plane_hash_foreach_near(&groups->hash, plane, note_near_plane, groups);
+    if (groups->same != G_MAXUINT32) {
+        return groups->same;
+    }
+
+    auto const index = rmf_plane_hash_add(&groups->hash, plane);
+    g_array_append_val(groups->parents, index);
+    for (guint i = 0; i < groups->nearby->len; ++i) {
+        auto const other = g_array_index(groups->nearby, rmf_int, i);
+        auto const root = find_group(groups->parents, other);
+        g_array_index(groups->parents, rmf_int, root) = index;
+    }
+    return index;
+}
+
+// Report the overlapping faces of different solids among @keys, which are all
+// in one group of planes, skipping pairs whose planes are further apart than
+// @tolerance. Sweeps along the first projected axis, like the broad phase of
+// rmf_bvh_find_overlapping_solids().
+static void find_overlapping_faces(
+    RmfBvh *self,
+    RmfBvhHulls const *hulls,
+    FaceKey const *keys,
+    rmf_int begin,
+    rmf_int end,
+    rmf_float tolerance,
+    GArray *spans,
+    GArray *results
+)
+{
+    auto const first = &keys[begin];
+    RmfVector const n = {
+        hulls->nx[first->plane],
+        hulls->ny[first->plane],
+        hulls->nz[first->plane],
+    };
+    guint u, v;
+    project_axes(&n, &u, &v);
+
+    g_array_set_size(spans, 0);
+    for (rmf_int i = begin; i < end; ++i) {
+        auto const plane = keys[i].plane;
+        FaceSpan span = {G_MAXFLOAT, -G_MAXFLOAT, G_MAXFLOAT, -G_MAXFLOAT, i};
+        auto const first_vertex = hulls->plane_vertex[plane];
+        auto const end_vertex = hulls->plane_vertex[plane + 1];
+        for (auto k = first_vertex; k < end_vertex; ++k) {
+            span.min_u = MIN(span.min_u, vertex_axis(hulls, k, u));
+            span.max_u = MAX(span.max_u, vertex_axis(hulls, k, u));
+            span.min_v = MIN(span.min_v, vertex_axis(hulls, k, v));
+            span.max_v = MAX(span.max_v, vertex_axis(hulls, k, v));
+        }
+        if (first_vertex < end_vertex) {
+            g_array_append_val(spans, span);
+        }
+    }
+    g_array_sort(spans, compare_face_spans);
+
+    auto const sorted = (FaceSpan const *)spans->data;
+    for (guint i = 0; i < spans->len; ++i) {
+        auto const a = &sorted[i];
+        auto const ka = &keys[a->key];
+        for (guint j = i + 1; j < spans->len; ++j) {
+            auto const b = &sorted[j];
+            auto const kb = &keys[b->key];
+            if (b->min_u >= a->max_u - tolerance) {
+                break;
+            }
+            auto const pa = hull_plane(hulls, ka->plane);
+            auto const pb = hull_plane(hulls, kb->plane);
+            if (ka->object == kb->object
+                || !rmf_planes_match(&pa, &pb, NORMAL_EPSILON, tolerance)
+                || b->min_v >= a->max_v - tolerance
+                || a->min_v >= b->max_v - tolerance
+                || edges_separate(hulls, ka->plane, kb->plane, u, v, tolerance)
+                || edges_separate(hulls, kb->plane, ka->plane, u, v, tolerance))
+            {
+                continue;
+            }
+            auto const node_a = self->objects[ka->object];
+            auto const node_b = self->objects[kb->object];
+            auto const face_a = ka->plane - hulls->first[ka->object];
+            auto const face_b = kb->plane - hulls->first[kb->object];
+            RmfFacePair const pair = node_a < node_b
+                ? (RmfFacePair){node_a, face_a, node_b, face_b}
+                : (RmfFacePair){node_b, face_b, node_a, face_a};
+            g_array_append_val(results, pair);
+        }
+    }
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_bvh_find_overlapping_solids:
+ * @bvh: The hierarchy.
+ * @tolerance: How far solids may reach into each other before they count as
+ *   overlapping.
+ *
+ * Finds the pairs of solids which overlap each other by more than @tolerance.
+ * Solids which only touch do not overlap.
+ *
+ * Candidate pairs are those whose bounds overlap, found by sorting the solids
+ * along X and sweeping over them. Each candidate pair is then tested, in
+ * parallel, for a face plane of either solid with the whole of the other
+ * solid in front of it. Solids which can only be told apart along an axis
+ * through two of their edges are still reported, so a few pairs of solids
+ * whose edges pass close by each other may be found as well.
+ *
+ * Returns: (transfer full) (element-type RmfNodePair): The overlapping pairs,
+ * sorted by their first node.
+ */
+GArray *rmf_bvh_find_overlapping_solids(RmfBvh *self, rmf_float tolerance)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+
+    auto const hulls = rmf_bvh_get_hulls(self);
+    auto const bounds = self->bounds;
+
+    // Broad phase: sweep and prune along X.
+    g_autoptr(GArray) order = g_array_new(FALSE, FALSE, sizeof(rmf_int));
+    for (rmf_int i = 0; i < self->n_objects; ++i) {
+        if (hulls->first[i] < hulls->first[i + 1]) {
+            g_array_append_val(order, i);
+        }
+    }
+    g_array_sort_with_data(order, compare_min_x, bounds);
+
+    g_autoptr(GArray) candidates
+        = g_array_new(FALSE, FALSE, sizeof(RmfNodePair));
+    auto const sorted = (rmf_int const *)order->data;
+    for (guint i = 0; i < order->len; ++i) {
+        auto const a = &bounds[sorted[i]];
+        for (guint j = i + 1; j < order->len; ++j) {
+            auto const b = &bounds[sorted[j]];
+            if (b->min.x >= a->max.x - tolerance) {
+                break;
+            }
+            if (b->min.y < a->max.y - tolerance
+                && a->min.y < b->max.y - tolerance
+                && b->min.z < a->max.z - tolerance
+                && a->min.z < b->max.z - tolerance)
+            {
+                RmfNodePair const pair = {sorted[i], sorted[j]};
+                g_array_append_val(candidates, pair);
+            }
+        }
+    }
+
+    // Narrow phase: look for a separating face plane.
+    g_autofree guint8 *overlapping = g_new(guint8, candidates->len);
+    NarrowPhase phase = {
+        .hulls = hulls,
+        .tolerance = tolerance,
+        .pairs = (RmfNodePair const *)candidates->data,
+        .overlapping = overlapping,
+    };
+    rmf_parallel_for(candidates->len, PAIR_GRAIN, narrow_phase, &phase);
+
+    auto const pairs = g_array_new(FALSE, FALSE, sizeof(RmfNodePair));
+    for (guint i = 0; i < candidates->len; ++i) {
+        if (!overlapping[i]) {
+            continue;
+        }
+        auto const pair = &g_array_index(candidates, RmfNodePair, i);
+        auto const a = self->objects[pair->first];
+        auto const b = self->objects[pair->second];
+        RmfNodePair const result = {MIN(a, b), MAX(a, b)};
+        g_array_append_val(pairs, result);
+    }
+    g_array_sort(pairs, compare_pairs);
+    return pairs;
+}
+
+/**
+ * rmf_bvh_find_coplanar_faces:
+ * @bvh: The hierarchy.
+ * @tolerance: How far apart planes may be and still count as the same, and
+ *   how far faces must overlap. Must be positive.
+ *
+ * Finds the pairs of faces of different solids which lie in the same plane,
+ * face the same way and overlap by more than @tolerance. Such faces are drawn
+ * on top of each other, and flicker between each other when rendered.
+ *
+ * Faces are grouped through a spatial hash over their planes, joining each
+ * plane with those within @tolerance of it, so only faces in nearly the same
+ * plane are ever compared. Within a group, candidate pairs are found by
+ * sweeping along one axis and checked with a separating edge test.
+ *
+ * Returns: (transfer full) (element-type RmfFacePair): The coplanar faces,
+ * sorted by their first node.
+ */
+GArray *rmf_bvh_find_coplanar_faces(RmfBvh *self, rmf_float tolerance)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(tolerance > 0.0f, nullptr);
+
+    auto const hulls = rmf_bvh_get_hulls(self);
+    PlaneGroups groups = {
+        .parents = g_array_new(FALSE, FALSE, sizeof(rmf_int)),
+        .nearby = g_array_new(FALSE, FALSE, sizeof(rmf_int)),
+    };
+    rmf_plane_hash_init(&groups.hash, NORMAL_EPSILON, tolerance);
+    g_autoptr(GArray) keys = g_array_new(FALSE, FALSE, sizeof(FaceKey));
+    for (rmf_int i = 0; i < self->n_objects; ++i) {
+        for (auto plane = hulls->first[i]; plane < hulls->first[i + 1];
+             ++plane)
+        {
+            auto const p = hull_plane(hulls, plane);
+            // Degenerate faces have no normal.
+            if (p.normal.x == 0.0f && p.normal.y == 0.0f && p.normal.z == 0.0f)
+            {
+                continue;
+            }
+            FaceKey const key = {add_to_groups(&groups, &p), i, plane};
+            g_array_append_val(keys, key);
+        }
+    }
+    // Planes only join groups as they are added, so find the roots last.
+    for (guint i = 0; i < keys->len; ++i) {
+        auto const key = &g_array_index(keys, FaceKey, i);
+        key->group = find_group(groups.parents, key->group);
+    }
+    rmf_plane_hash_clear(&groups.hash);
+    g_array_unref(groups.parents);
+    g_array_unref(groups.nearby);
+    g_array_sort(keys, compare_face_keys);
+
+    auto const pairs = g_array_new(FALSE, FALSE, sizeof(RmfFacePair));
+    g_autoptr(GArray) spans = g_array_new(FALSE, FALSE, sizeof(FaceSpan));
+    auto const sorted = (FaceKey const *)keys->data;
+    for (guint begin = 0, end; begin < keys->len; begin = end) {
+        for (end = begin + 1; end < keys->len; ++end) {
+            if (sorted[end].group != sorted[begin].group) {
+                break;
+            }
+        }
+        if (end - begin > 1) {
+            find_overlapping_faces(
+                self,
+                hulls,
+                sorted,
+                begin,
+                end,
+                tolerance,
+                spans,
+                pairs
+            );
+        }
+    }
+    g_array_sort(pairs, compare_face_pairs);
+    return pairs;
+}
@@ -0,0 +1,36 @@
+#ifndef RMF_OVERLAP_H
+#define RMF_OVERLAP_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-bvh.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfNodePair
+
+typedef struct {
+    rmf_int first;
+    rmf_int second;
+} RmfNodePair;
+
+// RmfFacePair
+
+typedef struct {
+    rmf_int first_node;
+    rmf_int first_face;
+    rmf_int second_node;
+    rmf_int second_face;
+} RmfFacePair;
+
+GArray *rmf_bvh_find_overlapping_solids(RmfBvh *bvh, rmf_float tolerance);
+GArray *rmf_bvh_find_coplanar_faces(RmfBvh *bvh, rmf_float tolerance);
+
+G_END_DECLS
+
+#endif
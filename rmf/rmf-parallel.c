@@ -0,0 +1,144 @@
+#include "rmf/rmf-private.h"
+
+#include <glib.h>
+
+// One rmf_parallel_for() call. Helpers may start after the caller has returned,
+// so the job is reference counted and helpers hold a reference while running.
+typedef struct {
+    RmfParallelFunc func;
+    gpointer user_data;
+    guint n;
+    guint grain;
+    gint next;     // First index not yet claimed.
+    gint n_joined; // Participants so far, including the caller.
+    GMutex mutex;
+    GCond cond;
+    guint n_active; // Helpers still running.
+    bool closed;    // Whether late helpers should stay out.
+} Job;
+
+static void job_clear(Job *job)
+{
+    g_mutex_clear(&job->mutex);
+    g_cond_clear(&job->cond);
+}
+
+static void job_unref(Job *job)
+{
+    g_atomic_rc_box_release_full(job, (GDestroyNotify)job_clear);
+}
+
+// Claim chunks until none are left.
+static void job_run(Job *job, guint worker)
+{
+    for (;;) {
+        guint const begin = g_atomic_int_add(&job->next, job->grain);
+        if (begin >= job->n) {
+            break;
+        }
+        auto const end = MIN(begin + job->grain, job->n);
+        job->func(begin, end, worker, job->user_data);
+    }
+}
+
+static void helper_func(gpointer data, gpointer)
+{
+    Job *job = data;
+
+    g_mutex_lock(&job->mutex);
+    bool const join = !job->closed;
+    if (join) {
+        job->n_active++;
+    }
+    g_mutex_unlock(&job->mutex);
+
+    if (join) {
+        job_run(job, g_atomic_int_add(&job->n_joined, 1));
+
+        g_mutex_lock(&job->mutex);
+        if (--job->n_active == 0) {
+            g_cond_signal(&job->cond);
+        }
+        g_mutex_unlock(&job->mutex);
+    }
+    job_unref(job);
+}
+
+static GThreadPool *get_pool(void)
+{
+    static gsize pool = 0;
+    if (g_once_init_enter(&pool)) {
+        auto const n_helpers = (gint)rmf_parallel_n_workers() - 1;
+        auto const new_pool = g_thread_pool_new(
+            helper_func,
+            nullptr,
+            n_helpers,
+            FALSE,
+            nullptr
+        );
+        g_once_init_leave(&pool, (gsize)new_pool);
+    }
+    return (GThreadPool *)pool;
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Upper bound on the worker indices passed to a RmfParallelFunc.
+guint rmf_parallel_n_workers(void)
+{
+    static gsize n_workers = 0;
+    if (g_once_init_enter(&n_workers)) {
+        g_once_init_leave(&n_workers, MAX(g_get_num_processors(), 1));
+    }
+    return n_workers;
+}
+
+// Call @func over [0, @n) in chunks of @grain indices, spread over the shared
+// thread pool and the calling thread. Idle threads pick up the next unclaimed
+// chunk, so uneven chunks balance out. Returns once every chunk is done.
+//
+// The calling thread always takes part, so this may be called from within a
+// RmfParallelFunc without deadlocking the pool.
+void rmf_parallel_for(
+    guint n,
+    guint grain,
+    RmfParallelFunc func,
+    gpointer user_data
+)
+{
+    grain = MAX(grain, 1);
+    auto const n_chunks = n / grain + (n % grain != 0);
+    auto const n_helpers = MIN(n_chunks, rmf_parallel_n_workers()) - 1;
+    if (n_chunks <= 1 || n_helpers == 0) {
+        if (n > 0) {
+            func(0, n, 0, user_data);
+        }
+        return;
+    }
+
+    Job *job = g_atomic_rc_box_new0(Job);
+    job->func = func;
+    job->user_data = user_data;
+    job->n = n;
+    job->grain = grain;
+    job->n_joined = 1;
+    g_mutex_init(&job->mutex);
+    g_cond_init(&job->cond);
+
+    auto const pool = get_pool();
+    for (guint i = 0; i < n_helpers; ++i) {
+        g_thread_pool_push(pool, g_atomic_rc_box_acquire(job), nullptr);
+    }
+
+    job_run(job, 0);
+
+    // Helpers which have not started by now find nothing left to do.
+    g_mutex_lock(&job->mutex);
+    job->closed = true;
+    while (job->n_active > 0) {
+        g_cond_wait(&job->cond, &job->mutex);
+    }
+    g_mutex_unlock(&job->mutex);
+
+    job_unref(job);
+}
@@ -0,0 +1,478 @@
+#include "rmf/rmf-planetable.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * RmfPlane:
+ * @normal: Unit normal of the plane.
+ * @distance: Distance of the plane from the origin along @normal.
+ *
+ * A plane, holding the points p with `dot(normal, p) = distance`.
+ */
+
+/**
+ * RMF_PLANE_TABLE_NO_PLANE:
+ *
+ * The plane index of a face whose plane points don't make a plane.
+ */
+
+/**
+ * RMF_PLANE_TABLE_NORMAL_EPSILON:
+ *
+ * The normal epsilon of the plane table built by
+ * [flags@RmfLoaderFlags.PLANE_TABLE].
+ */
+
+/**
+ * RMF_PLANE_TABLE_DISTANCE_EPSILON:
+ *
+ * The distance epsilon of the plane table built by
+ * [flags@RmfLoaderFlags.PLANE_TABLE].
+ */
+
+/**
+ * RmfPlaneTable:
+ *
+ * The distinct planes of the faces of an [struct@RmfModel], with the plane
+ * index of every face.
+ *
+ * Faces of neighbouring solids often lie in the same plane. The table lists
+ * each plane once, so that faces can be compared by index, and tools which
+ * work with planes rather than plane points can share them. Planes face out
+ * of their solid, so the two sides of a wall between two solids are two
+ * planes.
+ *
+ * Load with [flags@RmfLoaderFlags.PLANE_TABLE] to build one, and get it with
+ * [method@RmfRoot.get_plane_table], or build one with different epsilons with
+ * [ctor@RmfPlaneTable.new].
+ */
+struct _RmfPlaneTable {
+    RmfModel *model;
+    RmfPlane *planes;
+    rmf_int *face_planes; // Plane index of each face, solid by solid.
+    rmf_int *first;       // First face of each solid record, and one past.
+    rmf_int n_planes;
+};
+
+G_DEFINE_BOXED_TYPE(
+    RmfPlaneTable,
+    rmf_plane_table,
+    rmf_plane_table_ref,
+    rmf_plane_table_unref
+)
+
+// Solids per chunk of the parallel part of the build.
+#define SOLID_GRAIN 256
+
+// Marks a solid record no node refers to.
+#define NO_NODE G_MAXUINT32
+
+typedef struct {
+    RmfModel *model;
+    rmf_int const *solid_nodes; // Node of each solid record, or NO_NODE.
+    rmf_int const *first;
+    RmfPlane *planes; // Of each face, before merging.
+} FacePlanes;
+
+// Cells of an RmfPlaneHash are twice the epsilons wide, so that the planes
+// within the epsilons of a plane are all in its own cell or its nearer
+// neighbour along each dimension. Cells are centred on whole multiples of
+// their size, which puts the axis-aligned and grid-snapped planes of most maps
+// well clear of the edges.
+typedef struct {
+    gint32 c[4];
+} Cell;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static guint cell_hash(gconstpointer key)
+{
+    Cell const *cell = key;
+    guint hash = 17;
+    for (guint i = 0; i < 4; ++i) {
+        hash = hash * 31 + (guint)cell->c[i];
+    }
+    return hash;
+}
+
+static gboolean cell_equal(gconstpointer a, gconstpointer b)
+{
+    return memcmp(a, b, sizeof(Cell)) == 0;
+}
+
+// Get the cell of component @x, and the neighbour a value within @epsilon of
+// it could be in, which is the nearer one. From the centre, a value exactly
+// @epsilon above is in the next cell up, so that one counts as nearer.
+static gint32 to_cell(rmf_float x, rmf_float epsilon, gint32 *neighbour)
+{
+    auto const scaled = x / (2.0f * epsilon);
+    auto const cell = floorf(scaled + 0.5f);
+    *neighbour = scaled < cell ? -1 : 1;
+    return (gint32)cell;
+}
+
+static Cell plane_cell(
+    RmfPlaneHash const *self,
+    RmfPlane const *plane,
+    gint32 *neighbour
+)
+{
+    auto const ne = self->normal_epsilon;
+    auto const de = self->distance_epsilon;
+    Cell cell;
+    cell.c[0] = to_cell(plane->normal.x, ne, &neighbour[0]);
+    cell.c[1] = to_cell(plane->normal.y, ne, &neighbour[1]);
+    cell.c[2] = to_cell(plane->normal.z, ne, &neighbour[2]);
+    cell.c[3] = to_cell(plane->distance, de, &neighbour[3]);
+    return cell;
+}
+
+static RmfVector solid_centroid(GPtrArray *faces)
+{
+    RmfVector sum = {};
+    rmf_int n = 0;
+    for (guint i = 0; i < faces->len; ++i) {
+        RmfFace const *face = g_ptr_array_index(faces, i);
+        for (rmf_int j = 0; j < face->n_vertices; ++j) {
+            sum.x += face->vertices[j].x;
+            sum.y += face->vertices[j].y;
+            sum.z += face->vertices[j].z;
+        }
+        n += face->n_vertices;
+    }
+    if (n == 0) {
+        return sum;
+    }
+    return (RmfVector){sum.x / n, sum.y / n, sum.z / n};
+}
+
+// Work out the plane of every face of the solid records [@begin, @end),
+// decoding lazy faces on the way. Faces which failed to decode get no plane.
+static void find_face_planes(guint begin, guint end, guint, gpointer user_data)
+{
+    FacePlanes const *fp = user_data;
+    for (guint i = begin; i < end; ++i) {
+        auto const planes = &fp->planes[fp->first[i]];
+        auto const n_faces = fp->first[i + 1] - fp->first[i];
+        auto const node = fp->solid_nodes[i];
+        GPtrArray *faces = nullptr;
+        if (node != NO_NODE) {
+            faces = rmf_model_get_solid_faces(fp->model, node);
+        }
+        guint n_decoded = 0;
+        if (faces != nullptr) {
+            n_decoded = MIN(faces->len, n_faces);
+            auto const inside = solid_centroid(faces);
+            for (guint j = 0; j < n_decoded; ++j) {
+                RmfFace const *face = g_ptr_array_index(faces, j);
+                if (!rmf_plane_from_face(&planes[j], face, &inside)) {
+                    planes[j].distance = NAN;
+                }
+            }
+        }
+        for (guint j = n_decoded; j < n_faces; ++j) {
+            planes[j].distance = NAN;
+        }
+    }
+}
+
+static bool take_first(rmf_int index, gpointer user_data)
+{
+    *(rmf_int *)user_data = index;
+    return false;
+}
+
+// Find the plane added so far within the epsilons of @plane, or add it.
+static rmf_int merge_plane(RmfPlaneHash *hash, RmfPlane const *plane)
+{
+    rmf_int found = RMF_PLANE_TABLE_NO_PLANE;
+    rmf_plane_hash_foreach_near(hash, plane, take_first, &found);
+    if (found != RMF_PLANE_TABLE_NO_PLANE) {
+        return found;
+    }
+    return rmf_plane_hash_add(hash, plane);
+}
+
+static void plane_table_clear(RmfPlaneTable *self)
+{
+    g_free(self->planes);
+    g_free(self->face_planes);
+    g_free(self->first);
+    rmf_model_unref(self->model);
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_plane_table_new:
+ * @model: The model whose faces to gather the planes of.
+ * @normal_epsilon: Most each component of two normals may differ by for them
+ *   to be the same, eg. [const@PLANE_TABLE_NORMAL_EPSILON].
+ * @distance_epsilon: Most two distances may differ by for them to be the
+ *   same, eg. [const@PLANE_TABLE_DISTANCE_EPSILON].
+ *
+ * Builds a plane table of the faces of a model, decoding them if they were
+ * loaded lazily. The faces are decoded and their planes worked out over a
+ * shared thread pool and the calling thread.
+ *
+ * A face is given the first plane found within the epsilons of its own, so
+ * which of several nearly equal planes it gets depends on the order of the
+ * solids.
+ *
+ * Returns: (transfer full): The new table.
+ */
+RmfPlaneTable *rmf_plane_table_new(
+    RmfModel *model,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+)
+{
+    g_return_val_if_fail(model != nullptr, nullptr);
+    g_return_val_if_fail(normal_epsilon > 0.0f, nullptr);
+    g_return_val_if_fail(distance_epsilon > 0.0f, nullptr);
+
+    RmfPlaneTable *self = g_atomic_rc_box_new0(RmfPlaneTable);
+    self->model = rmf_model_ref(model);
+
+    // Solid records only know their face counts, which is enough to lay out
+    // the faces before decoding any.
+    auto const n_solids = model->solids->len;
+    g_autofree rmf_int *solid_nodes = g_new(rmf_int, n_solids);
+    for (rmf_int i = 0; i < n_solids; ++i) {
+        solid_nodes[i] = NO_NODE;
+    }
+    for (rmf_int i = 0; i < model->nodes->len; ++i) {
+        auto const node = rmf_model_node(model, i);
+        if (node->object_type == RMF_OBJECT_TYPE_SOLID) {
+            solid_nodes[node->payload] = i;
+        }
+    }
+    self->first = g_new(rmf_int, n_solids + 1);
+    self->first[0] = 0;
+    for (rmf_int i = 0; i < n_solids; ++i) {
+        auto const n_faces = rmf_model_solid(model, i)->n_faces;
+        self->first[i + 1] = self->first[i] + n_faces;
+    }
+    auto const n_faces = self->first[n_solids];
+
+    g_autofree RmfPlane *face_planes = g_new(RmfPlane, n_faces);
+    FacePlanes fp = {model, solid_nodes, self->first, face_planes};
+    rmf_parallel_for(n_solids, SOLID_GRAIN, find_face_planes, &fp);
+
+    RmfPlaneHash hash;
+    rmf_plane_hash_init(&hash, normal_epsilon, distance_epsilon);
+    self->face_planes = g_new(rmf_int, n_faces);
+    for (rmf_int i = 0; i < n_faces; ++i) {
+        self->face_planes[i] = isnan(face_planes[i].distance)
+                                 ? RMF_PLANE_TABLE_NO_PLANE
+                                 : merge_plane(&hash, &face_planes[i]);
+    }
+    self->n_planes = hash.planes->len;
+    auto const planes = g_steal_pointer(&hash.planes);
+    self->planes = (RmfPlane *)g_array_free(planes, FALSE);
+    rmf_plane_hash_clear(&hash);
+    return self;
+}
+
+/**
+ * rmf_plane_table_ref:
+ * @table: The table.
+ *
+ * Increases the reference count of a plane table.
+ *
+ * Returns: (transfer full): The table.
+ */
+RmfPlaneTable *rmf_plane_table_ref(RmfPlaneTable *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_plane_table_unref:
+ * @table: (transfer full): The table.
+ *
+ * Decreases the reference count of a plane table, freeing it when it reaches
+ * zero.
+ */
+void rmf_plane_table_unref(RmfPlaneTable *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)plane_table_clear);
+}
+
+/**
+ * rmf_plane_table_get_planes:
+ * @table: The table.
+ * @n_planes: (out): Return location for the number of planes.
+ *
+ * Gets the distinct planes of the table.
+ *
+ * Returns: (array length=n_planes) (transfer none): The planes.
+ */
+RmfPlane const *
+rmf_plane_table_get_planes(RmfPlaneTable *self, guint *n_planes)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_planes != nullptr, nullptr);
+    *n_planes = self->n_planes;
+    return self->planes;
+}
+
+/**
+ * rmf_plane_table_get_face_planes:
+ * @table: The table.
+ * @index: Index of a solid's node in the model.
+ * @n_faces: (out): Return location for the number of faces of the solid.
+ *
+ * Gets the plane index of each face of a solid, in the order of
+ * [method@RmfSolid.get_face_array], or [const@PLANE_TABLE_NO_PLANE] for faces
+ * whose plane points don't make a plane.
+ *
+ * Returns: (array length=n_faces) (transfer none): The plane indices.
+ */
+rmf_int const *rmf_plane_table_get_face_planes(
+    RmfPlaneTable *self,
+    rmf_int index,
+    guint *n_faces
+)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(n_faces != nullptr, nullptr);
+    g_return_val_if_fail(index < self->model->nodes->len, nullptr);
+    auto const node = rmf_model_node(self->model, index);
+    g_return_val_if_fail(node->object_type == RMF_OBJECT_TYPE_SOLID, nullptr);
+    auto const first = self->first[node->payload];
+    *n_faces = self->first[node->payload + 1] - first;
+    return self->face_planes + first;
+}
+
+// Internal ////////////////////////////////////////////////////////////////////
+
+// Whether two planes are within the epsilons of each other.
+bool rmf_planes_match(
+    RmfPlane const *a,
+    RmfPlane const *b,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+)
+{
+    return fabsf(a->normal.x - b->normal.x) <= normal_epsilon
+        && fabsf(a->normal.y - b->normal.y) <= normal_epsilon
+        && fabsf(a->normal.z - b->normal.z) <= normal_epsilon
+        && fabsf(a->distance - b->distance) <= distance_epsilon;
+}
+
+void rmf_plane_hash_init(
+    RmfPlaneHash *self,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+)
+{
+    self->planes = g_array_new(FALSE, FALSE, sizeof(RmfPlane));
+    self->next = g_array_new(FALSE, FALSE, sizeof(rmf_int));
+    self->cells = g_hash_table_new_full(cell_hash, cell_equal, g_free, nullptr);
+    self->normal_epsilon = normal_epsilon;
+    self->distance_epsilon = distance_epsilon;
+}
+
+void rmf_plane_hash_clear(RmfPlaneHash *self)
+{
+    g_clear_pointer(&self->planes, g_array_unref);
+    g_clear_pointer(&self->next, g_array_unref);
+    g_clear_pointer(&self->cells, g_hash_table_unref);
+}
+
+// Add @plane, returning its index, even if an equal plane was added before.
+rmf_int rmf_plane_hash_add(RmfPlaneHash *self, RmfPlane const *plane)
+{
+    gint32 neighbour[4];
+    auto const cell = plane_cell(self, plane, neighbour);
+    rmf_int const index = self->planes->len;
+    rmf_int const next
+        = GPOINTER_TO_UINT(g_hash_table_lookup(self->cells, &cell)) - 1;
+    g_array_append_val(self->planes, *plane);
+    g_array_append_val(self->next, next);
+    g_hash_table_replace(
+        self->cells,
+        g_memdup2(&cell, sizeof(cell)),
+        GUINT_TO_POINTER(index + 1)
+    );
+    return index;
+}
+
+// Call @func with the index of each plane added so far within the epsilons of
+// @plane, until it returns false.
+void rmf_plane_hash_foreach_near(
+    RmfPlaneHash const *self,
+    RmfPlane const *plane,
+    RmfPlaneHashFunc func,
+    gpointer user_data
+)
+{
+    gint32 neighbour[4];
+    auto const cell = plane_cell(self, plane, neighbour);
+
+    // Each bit of @mask moves one dimension over to its neighbour.
+    for (guint mask = 0; mask < 16; ++mask) {
+        Cell probe = cell;
+        for (guint i = 0; i < 4; ++i) {
+            if (mask & (1u << i)) {
+                probe.c[i] += neighbour[i];
+            }
+        }
+        rmf_int other
+            = GPOINTER_TO_UINT(g_hash_table_lookup(self->cells, &probe)) - 1;
+        for (; other != G_MAXUINT32;
+             other = g_array_index(self->next, rmf_int, other))
+        {
+            auto const candidate
+                = &g_array_index(self->planes, RmfPlane, other);
+            if (rmf_planes_match(
+                    plane,
+                    candidate,
+                    self->normal_epsilon,
+                    self->distance_epsilon
+                )
+                && !func(other, user_data))
+            {
+                return;
+            }
+        }
+    }
+}
+
+// Get the plane through @face's plane points, facing away from @inside.
+// Returns false if the points don't make a plane.
+bool rmf_plane_from_face(
+    RmfPlane *plane,
+    RmfFace const *face,
+    RmfVector const *inside
+)
+{
+    auto const p = face->plane_points;
+    RmfVector const u = {p[1].x - p[0].x, p[1].y - p[0].y, p[1].z - p[0].z};
+    RmfVector const v = {p[2].x - p[0].x, p[2].y - p[0].y, p[2].z - p[0].z};
+    RmfVector n = {
+        u.y * v.z - u.z * v.y,
+        u.z * v.x - u.x * v.z,
+        u.x * v.y - u.y * v.x,
+    };
+    auto const length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+    if (!(length > 0.0f)) {
+        return false;
+    }
+    n = (RmfVector){n.x / length, n.y / length, n.z / length};
+    auto d = n.x * p[0].x + n.y * p[0].y + n.z * p[0].z;
+    if (n.x * inside->x + n.y * inside->y + n.z * inside->z > d) {
+        n = (RmfVector){-n.x, -n.y, -n.z};
+        d = -d;
+    }
+    *plane = (RmfPlane){n, d};
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef RMF_PLANETABLE_H
+#define RMF_PLANETABLE_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-model.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfPlane
+
+typedef struct {
+    RmfVector normal;
+    rmf_float distance;
+} RmfPlane;
+
+// RmfPlaneTable
+
+#define RMF_TYPE_PLANE_TABLE rmf_plane_table_get_type()
+
+#define RMF_PLANE_TABLE_NO_PLANE G_MAXUINT32
+#define RMF_PLANE_TABLE_NORMAL_EPSILON 1e-4f
+#define RMF_PLANE_TABLE_DISTANCE_EPSILON 1e-2f
+
+typedef struct _RmfPlaneTable RmfPlaneTable;
+
+GType rmf_plane_table_get_type(void);
+RmfPlaneTable *rmf_plane_table_new(
+    RmfModel *model,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+);
+RmfPlaneTable *rmf_plane_table_ref(RmfPlaneTable *table);
+void rmf_plane_table_unref(RmfPlaneTable *table);
+RmfPlane const *
+rmf_plane_table_get_planes(RmfPlaneTable *table, guint *n_planes);
+rmf_int const *rmf_plane_table_get_face_planes(
+    RmfPlaneTable *table,
+    rmf_int index,
+    guint *n_faces
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfPlaneTable, rmf_plane_table_unref)
+
+G_END_DECLS
+
+#endif
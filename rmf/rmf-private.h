@@ -5,35 +5,313 @@
 #  error "Only <rmf.h> can be included directly."
 #endif
 
+#include "rmf/rmf-bvh.h"
 #include "rmf/rmf-entity.h"
 #include "rmf/rmf-entitydata.h"
+#include "rmf/rmf-geometry.h"
 #include "rmf/rmf-group.h"
 #include "rmf/rmf-loader.h"
 #include "rmf/rmf-mapobject.h"
+#include "rmf/rmf-model.h"
+#include "rmf/rmf-node.h"
+#include "rmf/rmf-planetable.h"
 #include "rmf/rmf-solid.h"
+#include "rmf/rmf-stringpool.h"
 #include "rmf/rmf-structs.h"
+#include "rmf/rmf-trace.h"
 #include "rmf/rmf-types.h"
 #include "rmf/rmf-worldspawn.h"
 
 #include <glib.h>
+#include <stdalign.h>
 #include <stddef.h>
+#include <string.h>
+
+// rmf-arena
+
+typedef struct _RmfArena RmfArena;
+
+struct _RmfArena {
+    struct _RmfArenaChunk *head; // Newest first.
+    guint8 *pos;
+    guint8 *end;
+    struct _RmfArenaKeep *keep; // Released along with the arena.
+};
+
+RmfArena *rmf_arena_new(void);
+RmfArena *rmf_arena_ref(RmfArena *self);
+void rmf_arena_unref(RmfArena *self);
+void rmf_arena_keep(RmfArena *self, gpointer data, GDestroyNotify destroy);
+gpointer rmf_arena_alloc_slow(RmfArena *self, size_t size);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfArena, rmf_arena_unref)
+
+static inline gpointer
+rmf_arena_alloc_aligned(RmfArena *self, size_t size, size_t align)
+{
+    auto const pos = (guint8 *)(((guintptr)self->pos + align - 1) & -align);
+    if (G_LIKELY(pos <= self->end && size <= (size_t)(self->end - pos))) {
+        self->pos = pos + size;
+        return pos;
+    }
+    return rmf_arena_alloc_slow(self, size);
+}
+
+static inline gpointer rmf_arena_alloc(RmfArena *self, size_t size)
+{
+    return rmf_arena_alloc_aligned(self, size, alignof(max_align_t));
+}
+
+// Copy @length bytes of @string, adding a null byte.
+static inline char *
+rmf_arena_strndup(RmfArena *self, char const *string, size_t length)
+{
+    char *copy = rmf_arena_alloc_aligned(self, length + 1, 1);
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
 
 // rmf-loader
-void rmf_loader_set_offset(RmfLoader *self, size_t offset);
-void rmf_loader_seek(RmfLoader *self, goffset n);
-void rmf_loader_read(RmfLoader *restrict self, size_t n, void *restrict dest);
-void rmf_loader_log_begin(
+
+// Readers for records whose layout depends on the RMF version. Picked once per
+// load by rmf_readers_for_version().
+typedef struct {
+    void (*read_face)(RmfLoader *restrict self, RmfFace *restrict face);
+    size_t face_size; // Size of the fixed-length part of a face.
+} RmfReaders;
+
+// Read position into the loader's data. Plain pointers, so that the rmf_read_*
+// helpers boil down to a bounds check and a memcpy.
+typedef struct {
+    guint8 const *base;
+    guint8 const *end;
+    guint8 const *pos;
+} RmfCursor;
+
+typedef struct _RmfProgress RmfProgress;
+
+struct _RmfLoader {
+    GObject parent_instance;
+    char const *source;
+    GBytes *data;
+    RmfCursor cursor;
+    GError *error; // First error hit while parsing, if any.
+    rmf_float version;
+    RmfReaders const *readers;
+    RmfRoot *root;
+    RmfLoaderFlags flags;
+    RmfTraceSink *trace_sink; // Sink installed by the user.
+    RmfTraceSink *trace;      // Sink active for the current load, if any.
+    bool trace_text;
+    GPtrArray *tag_stack;
+    gint busy;                  // Set while a load is in progress.
+    GCancellable *cancellable;  // Cancellable of the current load, if any.
+    RmfStringPool *string_pool; // Pool shared between loads, if any.
+    RmfStringPool *strings;     // Interns the strings of the current load.
+    GHashTable *interned;       // Strings of @strings this loader has seen.
+    RmfArena *arena;            // Allocates the records of the current load.
+    RmfArena *scratch;          // Holds vertices bound for a geometry store.
+    RmfModel *model;            // Receives the map objects of the current load.
+    RmfProgress *progress;      // Progress reporting for async loads, if any.
+    gint64 progress_time;       // When progress was last reported.
+    guint n_objects;            // Map objects parsed so far.
+};
+
+RmfLoader *rmf_loader_fork(RmfLoader *self);
+RmfLoader *rmf_loader_new_for_data(
+    GBytes *data,
+    RmfReaders const *readers,
+    RmfStringPool *strings,
+    size_t offset
+);
+void rmf_loader_abort(RmfLoader *self, GError *error);
+void rmf_loader_fail(
+    RmfLoader *self,
+    gint code,
+    char const *format,
+    ...
+) G_GNUC_PRINTF(3, 4);
+void rmf_loader_tick_slow(RmfLoader *self);
+RmfModel *rmf_loader_read_model(RmfLoader *self);
+char const *
+rmf_loader_intern(RmfLoader *self, guint8 const *string, size_t size);
+
+// Allocate a record for the current load, from the heap if there is no arena.
+static inline gpointer rmf_loader_alloc(RmfLoader *self, size_t size)
+{
+    return self->arena ? rmf_arena_alloc(self->arena, size) : g_malloc(size);
+}
+
+// Allocate the vertices of a face. While building a geometry store they go to
+// scratch space, to be moved into the store at the end of the load.
+static inline RmfVector *rmf_loader_alloc_vertices(RmfLoader *self, rmf_int n)
+{
+    auto const size = n * sizeof(RmfVector);
+    if (self->scratch != nullptr) {
+        return rmf_arena_alloc_aligned(self->scratch, size, alignof(RmfVector));
+    }
+    return rmf_loader_alloc(self, size);
+}
+
+// Called once per map object, to honour cancellation and report progress.
+static inline void rmf_loader_tick(RmfLoader *self)
+{
+    self->n_objects++;
+    if (G_UNLIKELY(self->cancellable != nullptr || self->progress != nullptr)) {
+        rmf_loader_tick_slow(self);
+    }
+}
+
+static inline bool rmf_loader_failed(RmfLoader const *self)
+{
+    return self->error != nullptr;
+}
+
+static inline size_t rmf_loader_get_offset(RmfLoader const *self)
+{
+    return self->cursor.pos - self->cursor.base;
+}
+
+static inline size_t rmf_loader_get_remaining(RmfLoader const *self)
+{
+    return self->cursor.end - self->cursor.pos;
+}
+
+static inline void rmf_loader_set_offset(RmfLoader *self, size_t offset)
+{
+    auto const cursor = &self->cursor;
+    if (G_LIKELY(offset <= (size_t)(cursor->end - cursor->base))) {
+        cursor->pos = cursor->base + offset;
+    } else {
+        rmf_loader_fail(
+            self,
+            RMF_LOADER_ERROR_TRUNCATED,
+            "Offset %zu is past the end of the data",
+            offset
+        );
+    }
+}
+
+static inline void rmf_loader_seek(RmfLoader *self, goffset n)
+{
+    rmf_loader_set_offset(self, rmf_loader_get_offset(self) + n);
+}
+
+// Consume @n bytes, returning a pointer to them, or `nullptr` if there are not
+// that many left.
+static inline guint8 const *rmf_loader_take(RmfLoader *self, size_t n)
+{
+    auto const cursor = &self->cursor;
+    if (G_LIKELY(n <= (size_t)(cursor->end - cursor->pos))) {
+        auto const p = cursor->pos;
+        cursor->pos += n;
+        return p;
+    }
+    rmf_loader_fail(
+        self,
+        RMF_LOADER_ERROR_TRUNCATED,
+        "Unexpected end of data reading %zu bytes",
+        n
+    );
+    return nullptr;
+}
+
+static inline void
+rmf_loader_read(RmfLoader *restrict self, size_t n, void *restrict dest)
+{
+    auto const cursor = &self->cursor;
+    if (G_LIKELY(n <= (size_t)(cursor->end - cursor->pos))) {
+        memcpy(dest, cursor->pos, n);
+        cursor->pos += n;
+    } else {
+        // Hand back zeroes so callers can unwind without special-casing.
+        memset(dest, 0, n);
+        rmf_loader_fail(
+            self,
+            RMF_LOADER_ERROR_TRUNCATED,
+            "Unexpected end of data reading %zu bytes",
+            n
+        );
+    }
+}
+
+void rmf_loader_trace_begin(
     RmfLoader *loader,
     char const *tag,
+    char const *format,
     ...
-) G_GNUC_NULL_TERMINATED;
-void rmf_loader_log_oneline(
+) G_GNUC_PRINTF(3, 4);
+void rmf_loader_trace_oneline(
     RmfLoader *loader,
     char const *tag,
     char const *content,
+    char const *format,
     ...
-) G_GNUC_NULL_TERMINATED;
-void rmf_loader_log_end(RmfLoader *loader);
+) G_GNUC_PRINTF(4, 5);
+void rmf_loader_trace_end(RmfLoader *loader);
+
+// Tracing costs one pointer check unless a sink is active for the load, and
+// nothing at all when built with -Dtracing=false. Arguments are not evaluated
+// while tracing is off. @format is an optional printf-style format for the
+// record's attributes, eg. "count=\"%u\"".
+#ifdef RMF_DISABLE_TRACING
+#  define RMF_TRACE_ENABLED(loader) false
+#else
+#  define RMF_TRACE_ENABLED(loader) G_UNLIKELY((loader)->trace != nullptr)
+#endif
+
+#define RMF_TRACE_BEGIN(loader, tag, ...)                              \
+    G_STMT_START                                                       \
+    {                                                                  \
+        if (RMF_TRACE_ENABLED(loader)) {                               \
+            rmf_loader_trace_begin((loader), (tag), __VA_ARGS__);      \
+        }                                                              \
+    }                                                                  \
+    G_STMT_END
+
+#define RMF_TRACE_ONELINE(loader, tag, content, ...)                   \
+    G_STMT_START                                                       \
+    {                                                                  \
+        if (RMF_TRACE_ENABLED(loader)) {                               \
+            rmf_loader_trace_oneline(                                  \
+                (loader),                                              \
+                (tag),                                                 \
+                (content),                                             \
+                __VA_ARGS__                                            \
+            );                                                         \
+        }                                                              \
+    }                                                                  \
+    G_STMT_END
+
+#define RMF_TRACE_END(loader)                                          \
+    G_STMT_START                                                       \
+    {                                                                  \
+        if (RMF_TRACE_ENABLED(loader)) {                               \
+            rmf_loader_trace_end(loader);                              \
+        }                                                              \
+    }                                                                  \
+    G_STMT_END
+
+// rmf-parallel
+
+// Processes indices [@begin, @end). @worker is below rmf_parallel_n_workers()
+// and unique among the threads running one rmf_parallel_for() call, so it can
+// index per-thread state.
+typedef void (*RmfParallelFunc)(
+    guint begin,
+    guint end,
+    guint worker,
+    gpointer user_data
+);
+
+guint rmf_parallel_n_workers(void);
+void rmf_parallel_for(
+    guint n,
+    guint grain,
+    RmfParallelFunc func,
+    gpointer user_data
+);
 
 // rmf-types
 void rmf_read_byte(RmfLoader *restrict self, rmf_byte *restrict b);
@@ -42,18 +320,30 @@ void rmf_read_float(RmfLoader *restrict self, rmf_float *restrict f);
 void rmf_read_nstring(RmfLoader *restrict self, rmf_nstring *restrict nstring);
 void rmf_read_color(RmfLoader *restrict self, RmfColor *restrict color);
 void rmf_read_vector(RmfLoader *restrict self, RmfVector *restrict vector);
+void rmf_read_count(RmfLoader *restrict self, rmf_int *restrict n, size_t size);
+char const *rmf_read_interned_nstring(RmfLoader *self);
+char const *rmf_read_copied_nstring(RmfLoader *self);
+void rmf_skip_nstring(RmfLoader *self);
+void rmf_bounds_clear(RmfBounds *self);
+void rmf_bounds_add_points(RmfBounds *self, void const *points, size_t n);
+void rmf_bounds_union(RmfBounds *self, RmfBounds const *other);
 
 // rmf-structs
+RmfReaders const *rmf_readers_for_version(rmf_float version);
+
 void
 rmf_read_visgroup(RmfLoader *restrict self, RmfVisgroup *restrict visgroup);
 RmfVisgroup *rmf_visgroup_new(RmfLoader *loader);
+void rmf_skip_visgroup(RmfLoader *self);
 
 void rmf_read_face(RmfLoader *restrict self, RmfFace *restrict face);
 RmfFace *rmf_face_new(RmfLoader *self);
+void rmf_skip_face(RmfLoader *self, RmfBounds *bounds);
 
 void
 rmf_read_keyvalue(RmfLoader *restrict self, RmfKeyvalue *restrict keyvalue);
 RmfKeyvalue *rmf_keyvalue_new(RmfLoader *self);
+void rmf_skip_keyvalue(RmfLoader *self);
 
 void
 rmf_read_pathnode(RmfLoader *restrict self, RmfPathNode *restrict pathnode);
@@ -61,6 +351,7 @@ RmfPathNode *rmf_pathnode_new(RmfLoader *self);
 
 void rmf_read_path(RmfLoader *restrict self, RmfPath *restrict path);
 RmfPath *rmf_path_new(RmfLoader *self);
+void rmf_skip_path(RmfLoader *self);
 
 void rmf_read_camera(RmfLoader *restrict self, RmfCamera *restrict camera);
 RmfCamera *rmf_camera_new(RmfLoader *self);
@@ -72,31 +363,223 @@ RmfDocinfo *rmf_docinfo_new(RmfLoader *self);
 void rmf_read_root(RmfLoader *restrict loader, RmfRoot *restrict root);
 RmfRoot *rmf_root_new(RmfLoader *loader);
 
+// rmf-node
+void rmf_scan_map_object(
+    RmfLoader *loader,
+    GArray *nodes,
+    rmf_int parent,
+    rmf_int depth
+);
+
+// rmf-model
+
+// Type-specific part of a solid node.
+typedef struct {
+    rmf_int n_faces;
+    GPtrArray *faces;    // Not decoded yet if lazy.
+    size_t faces_offset; // Where to decode the faces from, if lazy.
+    RmfBounds bounds;
+} RmfSolidRecord;
+
+// Type-specific part of an entity or worldspawn node.
+typedef struct {
+    char const *classname; // Interned.
+    rmf_int spawnflags;
+    GPtrArray *keyvalues;
+    RmfVector origin; // Entities only.
+    GPtrArray *paths; // Worldspawns only.
+} RmfEntityRecord;
+
+struct _RmfModel {
+    GArray *nodes;    // Array<RmfModelNode>, each node's children in a row.
+    GArray *solids;   // Array<RmfSolidRecord>
+    GArray *entities; // Array<RmfEntityRecord>
+    RmfArena *arena;  // Owns the records of the load.
+
+    // Built once the load is done. Empty until then.
+    GArray *preorder;  // Array<RmfModelPreorderEntry>
+    GArray *positions; // Array<rmf_int>, the preorder position of each node.
+    GArray *bounds;    // Array<RmfBounds>, one for each node.
+
+    // Where lazy solids decode their faces from.
+    GBytes *data;
+    RmfReaders const *readers;
+    RmfStringPool *strings;
+};
+
+// Lengths of the arrays of a model, marking where the records of a subtree
+// start or end.
+typedef struct {
+    rmf_int nodes;
+    rmf_int solids;
+    rmf_int entities;
+} RmfModelMark;
+
+RmfModel *rmf_model_new(RmfLoader *loader);
+rmf_int rmf_model_add_nodes(RmfModel *self, rmf_int n);
+void rmf_model_mark(RmfModel const *self, RmfModelMark *mark);
+void rmf_model_graft(
+    RmfModel *self,
+    rmf_int index,
+    RmfModel *from,
+    RmfModelMark const *begin,
+    RmfModelMark const *end
+);
+void rmf_model_build_preorder(RmfModel *self);
+void rmf_model_build_bounds(RmfModel *self);
+GPtrArray *rmf_model_get_solid_faces(RmfModel *self, rmf_int index);
+GType rmf_object_type_get_object_gtype(RmfObjectType object_type);
+
+static inline RmfModelNode *rmf_model_node(RmfModel *self, rmf_int index)
+{
+    return &g_array_index(self->nodes, RmfModelNode, index);
+}
+
+static inline RmfSolidRecord *rmf_model_solid(RmfModel *self, rmf_int index)
+{
+    return &g_array_index(self->solids, RmfSolidRecord, index);
+}
+
+static inline RmfEntityRecord *rmf_model_entity(RmfModel *self, rmf_int index)
+{
+    return &g_array_index(self->entities, RmfEntityRecord, index);
+}
+
+// rmf-bvh
+
+// A node of an RmfBvh. Leaves hold @count objects from @first on. Inner nodes
+// have a @count of zero, their left child right after them and their right
+// child at @first.
+typedef struct {
+    RmfBounds bounds;
+    rmf_int first;
+    rmf_int count;
+} RmfBvhNode;
+
+// The convex hulls of the objects of an RmfBvh, as structure-of-arrays so that
+// loops over the planes or vertices of a solid vectorise. Point entities have
+// none.
+//
+// Plane i holds the points p with nx[i] * p.x + ny[i] * p.y + nz[i] * p.z =
+// d[i], and its normal points out of the solid. The planes of object i are
+// those from first[i] to first[i + 1], one for each face in order. Its
+// vertices, which repeat where faces meet, are those from first_vertex[i] to
+// first_vertex[i + 1], and the vertices of the face of plane i are those from
+// plane_vertex[i] to plane_vertex[i + 1].
+typedef struct {
+    rmf_float *nx;
+    rmf_float *ny;
+    rmf_float *nz;
+    rmf_float *d;
+    rmf_int *first;
+    rmf_float *vx;
+    rmf_float *vy;
+    rmf_float *vz;
+    rmf_int *first_vertex;
+    rmf_int *plane_vertex;
+} RmfBvhHulls;
+
+struct _RmfBvh {
+    RmfModel *model;
+    RmfBvhNode *nodes; // Root first. Some may be unused.
+    rmf_int *objects;  // Node indices into the model, leaf by leaf.
+    RmfBounds *bounds; // Of each object, in the same order.
+    rmf_int n_nodes;
+    rmf_int n_objects;
+    rmf_int depth;      // Number of nodes on the longest path from the root.
+    RmfBvhHulls *hulls; // Made on first use.
+};
+
+RmfBvhHulls const *rmf_bvh_get_hulls(RmfBvh *self);
+void rmf_bvh_add_brush_entities(RmfBvh *self, GArray *results, guint begin);
+
+// rmf-planetable
+bool rmf_plane_from_face(
+    RmfPlane *plane,
+    RmfFace const *face,
+    RmfVector const *inside
+);
+bool rmf_planes_match(
+    RmfPlane const *a,
+    RmfPlane const *b,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+);
+
+// A spatial hash over planes, for finding those within the epsilons of a
+// plane without comparing it with all of them.
+typedef struct {
+    GArray *planes;    // Array<RmfPlane>
+    GArray *next;      // Array<rmf_int>, next plane in the same cell.
+    GHashTable *cells; // Cell to its latest plane plus one.
+    rmf_float normal_epsilon;
+    rmf_float distance_epsilon;
+} RmfPlaneHash;
+
+// Called for a plane of an RmfPlaneHash. Returns false to stop.
+typedef bool (*RmfPlaneHashFunc)(rmf_int index, gpointer user_data);
+
+void rmf_plane_hash_init(
+    RmfPlaneHash *self,
+    rmf_float normal_epsilon,
+    rmf_float distance_epsilon
+);
+void rmf_plane_hash_clear(RmfPlaneHash *self);
+rmf_int rmf_plane_hash_add(RmfPlaneHash *self, RmfPlane const *plane);
+void rmf_plane_hash_foreach_near(
+    RmfPlaneHash const *self,
+    RmfPlane const *plane,
+    RmfPlaneHashFunc func,
+    gpointer user_data
+);
+
 // rmf-mapobject
-RmfMapObject *rmf_map_object_new(RmfLoader *loader);
-RmfLoader *rmf_map_object_get_loader(RmfMapObject *self);
+RmfObjectType rmf_object_type_from_nstring(rmf_nstring const *nstring);
+void rmf_read_map_object(RmfLoader *loader, rmf_int index);
+void
+rmf_map_object_bind(RmfMapObject *self, RmfModel *model, rmf_int index);
+RmfModelNode const *
+rmf_map_object_peek_node(RmfMapObject *self, RmfModel **model);
+
+// The rmf_*_read() funcs read the part of a map object's record which follows
+// its children into a new record of the loader's model, returning its index.
+// The rmf_*_skip() funcs skip that part, as used by rmf_scan_map_object().
 
 // rmf-entitydata
-RmfEntityData *rmf_entity_data_new(RmfLoader *loader);
+void rmf_entity_data_read(RmfLoader *loader, RmfEntityRecord *record);
+void rmf_entity_data_skip(RmfLoader *loader);
 
 // rmf-worldspawn
-RmfWorldspawn *rmf_worldspawn_new(RmfLoader *loader);
+rmf_int rmf_worldspawn_read(RmfLoader *loader);
+void rmf_worldspawn_skip(RmfLoader *loader);
 
 // rmf-solid
-RmfSolid *rmf_solid_new(RmfLoader *loader);
+rmf_int rmf_solid_read(RmfLoader *loader);
+void rmf_solid_skip(RmfLoader *loader);
+
+// rmf-geometry
+RmfGeometry *rmf_geometry_new_for_model(RmfModel *model);
 
 // rmf-entity
-RmfEntity *rmf_entity_new(RmfLoader *loader);
+rmf_int rmf_entity_read(RmfLoader *loader);
+void rmf_entity_skip(RmfLoader *loader);
 
-// rmf-group
-RmfGroup *rmf_group_new(RmfLoader *loader);
+// Get the items of @array, which may be `nullptr`, as a pointer and length.
+static inline gpointer const *rmf_ptr_array_span(GPtrArray *array, guint *len)
+{
+    *len = array ? array->len : 0;
+    return array ? (gpointer const *)array->pdata : nullptr;
+}
 
-// Convenience macro to define iterators sourced from a GPtrArray.
+// Convenience macro to define iterators sourced from a GPtrArray. Iterators
+// keep the object owning the items alive, since the items may be allocated
+// from its arena.
 #define RMF_DEFINE_ITERATOR_TYPE(IT, i_t, MODULE, OBJ_NAME, RT)            \
     struct _##IT {                                                         \
         GObject parent_instance;                                           \
         size_t index;                                                      \
         GPtrArray *items;                                                  \
+        GObject *owner;                                                    \
     };                                                                     \
                                                                            \
     static void i_t##_iterator_interface_init(RmfIteratorInterface *iface) \
@@ -121,6 +604,7 @@ RmfGroup *rmf_group_new(RmfLoader *loader);
             g_ptr_array_unref(self->items);                                \
             self->items = nullptr;                                         \
         }                                                                  \
+        g_clear_object(&self->owner);                                      \
         G_OBJECT_CLASS(i_t##_parent_class)->dispose(object);               \
     }                                                                      \
                                                                            \
@@ -135,12 +619,13 @@ RmfGroup *rmf_group_new(RmfLoader *loader);
         self->items = nullptr;                                             \
     }                                                                      \
                                                                            \
-    static IT *i_t##_new(GPtrArray *items)                                 \
+    static IT *i_t##_new(GPtrArray *items, gpointer owner)                 \
     {                                                                      \
         IT *self = g_object_new(MODULE##_TYPE_##OBJ_NAME, nullptr);        \
         if (items) {                                                       \
             self->items = g_ptr_array_ref(items);                          \
         }                                                                  \
+        self->owner = g_object_ref(owner);                                 \
         return self;                                                       \
     }                                                                      \
                                                                            \
@@ -0,0 +1,287 @@
+#include "rmf/rmf-ray.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+#include <math.h>
+
+/**
+ * RmfRay:
+ * @origin: Where the ray starts.
+ * @direction: Which way the ray goes. Need not be normalised.
+ * @max_distance: How far the ray goes, in multiples of @direction.
+ *
+ * A ray segment to cast against an [struct@RmfBvh].
+ */
+
+/**
+ * RMF_RAY_NO_HIT:
+ *
+ * The @node of an [struct@RmfRayHit] for a ray which hit nothing, and its
+ * @face for a ray which starts inside the solid it hit.
+ */
+
+/**
+ * RmfRayHit:
+ * @node: Index in the model of the solid hit, or [const@RAY_NO_HIT].
+ * @face: Index of the face of the solid hit, or [const@RAY_NO_HIT] if the ray
+ *   starts inside the solid.
+ * @distance: How far along the ray the hit is, in multiples of its direction.
+ *
+ * Where a ray cast with [method@RmfBvh.cast_ray] first hits a solid.
+ */
+
+// Rays per chunk of a batch.
+#define RAY_GRAIN 64
+
+typedef struct {
+    RmfBvh *bvh;
+    RmfRay const *rays;
+    RmfRayHit *hits;
+} Batch;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+// Narrow [@enter, @leave] to where a ray is between @min and @max along one
+// axis. A ray parallel to the axis, whose inverse direction is infinite, is
+// either always or never between them, which the products below would turn
+// into NaN when @origin is on @min or @max.
+static void ray_slab(
+    rmf_float origin,
+    rmf_float inverse,
+    rmf_float min,
+    rmf_float max,
+    rmf_float *enter,
+    rmf_float *leave
+)
+{
+    if (isinf(inverse)) {
+        if (origin < min || origin > max) {
+            *enter = INFINITY;
+            *leave = -INFINITY;
+        }
+        return;
+    }
+    auto const t0 = (min - origin) * inverse;
+    auto const t1 = (max - origin) * inverse;
+    *enter = MAX(*enter, MIN(t0, t1));
+    *leave = MIN(*leave, MAX(t0, t1));
+}
+
+// Where a ray enters and leaves a box, as multiples of its direction.
+static bool ray_box(
+    RmfVector const *origin,
+    RmfVector const *inverse,
+    RmfBounds const *box,
+    rmf_float max_distance,
+    rmf_float *enter
+)
+{
+    rmf_float from = 0.0f;
+    rmf_float to = max_distance;
+    ray_slab(origin->x, inverse->x, box->min.x, box->max.x, &from, &to);
+    ray_slab(origin->y, inverse->y, box->min.y, box->max.y, &from, &to);
+    ray_slab(origin->z, inverse->z, box->min.z, box->max.z, &from, &to);
+    *enter = from;
+    return from <= to;
+}
+
+// Clip @ray against the planes of a convex solid. Each plane cuts off where
+// the ray enters or where it leaves the solid's half of space; the ray hits if
+// it enters before it leaves. The loop has no branches, so it is vectorised
+// across the planes.
+static bool ray_solid(
+    RmfRay const *ray,
+    RmfBvhHulls const *hulls,
+    rmf_int first,
+    rmf_int end,
+    rmf_float max_distance,
+    rmf_float *distance,
+    rmf_int *face
+)
+{
+    auto const o = &ray->origin;
+    auto const dir = &ray->direction;
+    rmf_float enter = 0.0f;
+    rmf_float leave = max_distance;
+    rmf_int enter_face = RMF_RAY_NO_HIT;
+    bool outside = false;
+    for (rmf_int i = first; i < end; ++i) {
+        auto const speed = hulls->nx[i] * dir->x + hulls->ny[i] * dir->y
+                         + hulls->nz[i] * dir->z;
+        auto const height = hulls->nx[i] * o->x + hulls->ny[i] * o->y
+                          + hulls->nz[i] * o->z - hulls->d[i];
+        auto const t = -height / speed;
+        auto const enters = speed < 0.0f && t > enter;
+        outside |= speed == 0.0f && height > 0.0f;
+        enter = enters ? t : enter;
+        enter_face = enters ? i - first : enter_face;
+        leave = speed > 0.0f && t < leave ? t : leave;
+    }
+    if (outside || enter > leave) {
+        return false;
+    }
+    *distance = enter;
+    *face = enter_face;
+    return true;
+}
+
+static void cast_ray(RmfBvh *self, RmfRay const *ray, RmfRayHit *hit)
+{
+    *hit = (RmfRayHit){
+        .node = RMF_RAY_NO_HIT,
+        .face = RMF_RAY_NO_HIT,
+        .distance = ray->max_distance,
+    };
+    if (self->n_nodes == 0) {
+        return;
+    }
+
+    auto const hulls = rmf_bvh_get_hulls(self);
+    auto const dir = &ray->direction;
+    RmfVector const inverse = {1.0f / dir->x, 1.0f / dir->y, 1.0f / dir->z};
+
+    rmf_int stack_buf[64];
+    g_autofree rmf_int *stack_heap = nullptr;
+    auto stack = stack_buf;
+    if (self->depth >= G_N_ELEMENTS(stack_buf)) {
+        stack = stack_heap = g_new(rmf_int, self->depth + 1);
+    }
+
+    guint top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        auto const node = &self->nodes[stack[--top]];
+        rmf_float enter;
+        if (!ray_box(
+                &ray->origin,
+                &inverse,
+                &node->bounds,
+                hit->distance,
+                &enter
+            ))
+        {
+            continue;
+        }
+
+        if (node->count == 0) {
+            // Visit the nearer child first, so that later boxes are more
+            // likely to lie beyond the closest hit so far.
+            auto const left = node - self->nodes + 1;
+            auto const right = node->first;
+            rmf_float left_enter = G_MAXFLOAT;
+            rmf_float right_enter = G_MAXFLOAT;
+            ray_box(
+                &ray->origin,
+                &inverse,
+                &self->nodes[left].bounds,
+                hit->distance,
+                &left_enter
+            );
+            ray_box(
+                &ray->origin,
+                &inverse,
+                &self->nodes[right].bounds,
+                hit->distance,
+                &right_enter
+            );
+            bool const left_first = left_enter <= right_enter;
+            stack[top++] = left_first ? right : left;
+            stack[top++] = left_first ? left : right;
+            continue;
+        }
+
+        for (rmf_int i = node->first; i < node->first + node->count; ++i) {
+            auto const first = hulls->first[i];
+            auto const end = hulls->first[i + 1];
+            rmf_float distance;
+            rmf_int face;
+            if (first < end
+                && ray_box(
+                    &ray->origin,
+                    &inverse,
+                    &self->bounds[i],
+                    hit->distance,
+                    &enter
+                )
+                && ray_solid(
+                    ray,
+                    hulls,
+                    first,
+                    end,
+                    hit->distance,
+                    &distance,
+                    &face
+                ))
+            {
+                hit->node = self->objects[i];
+                hit->face = face;
+                hit->distance = distance;
+            }
+        }
+    }
+}
+
+static void cast_batch(guint begin, guint end, guint, gpointer user_data)
+{
+    Batch const *batch = user_data;
+    for (guint i = begin; i < end; ++i) {
+        cast_ray(batch->bvh, &batch->rays[i], &batch->hits[i]);
+    }
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_bvh_cast_ray:
+ * @bvh: The hierarchy.
+ * @ray: The ray to cast.
+ * @hit: (out caller-allocates): Return location for the closest hit.
+ *
+ * Finds where a ray first hits a solid. Solids are treated as the convex
+ * space inside their face planes. A ray starting inside a solid hits it at
+ * distance zero. Point entities are never hit.
+ *
+ * The face planes are worked out on the first cast, which decodes the faces
+ * of lazily loaded solids.
+ *
+ * Returns: `TRUE` if the ray hit a solid.
+ */
+gboolean rmf_bvh_cast_ray(RmfBvh *self, RmfRay const *ray, RmfRayHit *hit)
+{
+    g_return_val_if_fail(self != nullptr, FALSE);
+    g_return_val_if_fail(ray != nullptr, FALSE);
+    g_return_val_if_fail(hit != nullptr, FALSE);
+    cast_ray(self, ray, hit);
+    return hit->node != RMF_RAY_NO_HIT;
+}
+
+/**
+ * rmf_bvh_cast_rays:
+ * @bvh: The hierarchy.
+ * @rays: (array length=n_rays): The rays to cast.
+ * @hits: (array length=n_rays) (out caller-allocates): Return location for
+ *   the closest hit of each ray.
+ * @n_rays: Number of rays.
+ *
+ * Casts many rays at once, like [method@RmfBvh.cast_ray], spread over a
+ * shared thread pool and the calling thread. The @node of the hit of a ray
+ * which hits nothing is [const@RAY_NO_HIT].
+ */
+void rmf_bvh_cast_rays(
+    RmfBvh *self,
+    RmfRay const *rays,
+    RmfRayHit *hits,
+    guint n_rays
+)
+{
+    g_return_if_fail(self != nullptr);
+    g_return_if_fail(rays != nullptr || n_rays == 0);
+    g_return_if_fail(hits != nullptr || n_rays == 0);
+
+    // Work the planes out up front rather than in whichever thread is first.
+    rmf_bvh_get_hulls(self);
+    Batch batch = {.bvh = self, .rays = rays, .hits = hits};
+    rmf_parallel_for(n_rays, RAY_GRAIN, cast_batch, &batch);
+}
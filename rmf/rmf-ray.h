@@ -0,0 +1,43 @@
+#ifndef RMF_RAY_H
+#define RMF_RAY_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-bvh.h"
+#include "rmf/rmf-types.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfRay
+
+typedef struct {
+    RmfVector origin;
+    RmfVector direction;
+    rmf_float max_distance;
+} RmfRay;
+
+// RmfRayHit
+
+#define RMF_RAY_NO_HIT G_MAXUINT32
+
+typedef struct {
+    rmf_int node;
+    rmf_int face;
+    rmf_float distance;
+} RmfRayHit;
+
+gboolean rmf_bvh_cast_ray(RmfBvh *bvh, RmfRay const *ray, RmfRayHit *hit);
+void rmf_bvh_cast_rays(
+    RmfBvh *bvh,
+    RmfRay const *rays,
+    RmfRayHit *hits,
+    guint n_rays
+);
+
+G_END_DECLS
+
+#endif
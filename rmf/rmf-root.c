@@ -37,9 +37,12 @@ RMF_DEFINE_ITERATOR_TYPE(
  */
 struct _RmfRoot {
     GObject parent_instance;
+    RmfModel *model;      // Owns the records of the load.
     GPtrArray *visgroups; // PtrArray<RmfVisgroup>
     RmfWorldspawn *worldspawn;
     RmfDocinfo *docinfo;
+    RmfGeometry *geometry;      // Only with RMF_LOADER_FLAGS_GEOMETRY_STORE.
+    RmfPlaneTable *plane_table; // Only with RMF_LOADER_FLAGS_PLANE_TABLE.
 };
 
 G_DEFINE_FINAL_TYPE(RmfRoot, rmf_root, G_TYPE_OBJECT)
@@ -68,6 +71,9 @@ static void rmf_root_dispose(GObject *object)
         rmf_docinfo_free(self->docinfo);
         self->docinfo = nullptr;
     }
+    g_clear_pointer(&self->geometry, rmf_geometry_unref);
+    g_clear_pointer(&self->plane_table, rmf_plane_table_unref);
+    g_clear_pointer(&self->model, rmf_model_unref);
     G_OBJECT_CLASS(rmf_root_parent_class)->dispose(object);
 }
 
@@ -84,7 +90,10 @@ static void rmf_root_get_property(
         g_value_set_uint(value, self->visgroups->len);
         break;
     case PROP_VISGROUPS:
-        g_value_take_object(value, rmf_visgroup_iterator_new(self->visgroups));
+        g_value_take_object(
+            value,
+            rmf_visgroup_iterator_new(self->visgroups, self)
+        );
         break;
     case PROP_WORLDSPAWN:
         g_value_set_object(value, self->worldspawn);
@@ -174,9 +183,8 @@ static void rmf_root_init(RmfRoot *)
  */
 rmf_int rmf_root_get_n_visgroups(RmfRoot *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "n-visgroups", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ROOT(self), 0);
+    return self->visgroups ? self->visgroups->len : 0;
 }
 
 /**
@@ -189,9 +197,27 @@ rmf_int rmf_root_get_n_visgroups(RmfRoot *self)
  */
 RmfVisgroupIterator *rmf_root_get_visgroups(RmfRoot *self)
 {
-    RmfVisgroupIterator *value = nullptr;
-    g_object_get(self, "visgroups", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return rmf_visgroup_iterator_new(self->visgroups, self);
+}
+
+/**
+ * rmf_root_get_visgroup_array
+ * @root: The root.
+ * @n_visgroups: (out): Return location for the number of visgroups.
+ *
+ * Gets the visgroups in the RMF as an array, without making an iterator.
+ *
+ * Returns: (transfer none) (array length=n_visgroups) (nullable): The
+ * visgroups, valid as long as the root.
+ */
+RmfVisgroup *const *
+rmf_root_get_visgroup_array(RmfRoot *self, guint *n_visgroups)
+{
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    g_return_val_if_fail(n_visgroups != nullptr, nullptr);
+    auto const visgroups = self->visgroups;
+    return (RmfVisgroup *const *)rmf_ptr_array_span(visgroups, n_visgroups);
 }
 
 /**
@@ -204,9 +230,8 @@ RmfVisgroupIterator *rmf_root_get_visgroups(RmfRoot *self)
  */
 RmfWorldspawn *rmf_root_get_worldspawn(RmfRoot *self)
 {
-    RmfWorldspawn *value = nullptr;
-    g_object_get(self, "worldspawn", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return self->worldspawn;
 }
 
 /**
@@ -219,9 +244,82 @@ RmfWorldspawn *rmf_root_get_worldspawn(RmfRoot *self)
  */
 RmfDocinfo *rmf_root_get_docinfo(RmfRoot *self)
 {
-    RmfDocinfo *value = nullptr;
-    g_object_get(self, "docinfo", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return self->docinfo;
+}
+
+/**
+ * rmf_root_get_geometry
+ * @root: The root.
+ *
+ * Gets the store holding the vertices of all faces, if the RMF was loaded with
+ * [flags@RmfLoaderFlags.GEOMETRY_STORE].
+ *
+ * Returns: (transfer none) (nullable): The RMF's geometry store.
+ */
+RmfGeometry *rmf_root_get_geometry(RmfRoot *self)
+{
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return self->geometry;
+}
+
+/**
+ * rmf_root_get_plane_table
+ * @root: The root.
+ *
+ * Gets the distinct planes of all faces, if the RMF was loaded with
+ * [flags@RmfLoaderFlags.PLANE_TABLE].
+ *
+ * Returns: (transfer none) (nullable): The RMF's plane table.
+ */
+RmfPlaneTable *rmf_root_get_plane_table(RmfRoot *self)
+{
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return self->plane_table;
+}
+
+/**
+ * rmf_root_get_model
+ * @root: The root.
+ *
+ * Gets the table of all map objects in the RMF, the worldspawn being the node
+ * at index 0.
+ *
+ * Returns: (transfer none): The RMF's model.
+ */
+RmfModel *rmf_root_get_model(RmfRoot *self)
+{
+    g_return_val_if_fail(RMF_IS_ROOT(self), nullptr);
+    return self->model;
+}
+
+/**
+ * rmf_root_visit:
+ * @root: The root.
+ * @visitor: Callbacks to call for each type of object.
+ * @flags: Which types of object to visit, and in which order.
+ * @user_data: (closure): User data passed to the callbacks.
+ *
+ * Walks the whole object tree of the RMF, starting from its worldspawn. See
+ * [method@RmfMapObject.visit].
+ *
+ * Returns: `FALSE` if a callback stopped the walk, `TRUE` otherwise.
+ */
+gboolean rmf_root_visit(
+    RmfRoot *self,
+    RmfVisitor const *visitor,
+    RmfVisitFlags flags,
+    gpointer user_data
+)
+{
+    g_return_val_if_fail(RMF_IS_ROOT(self), FALSE);
+    g_return_val_if_fail(self->worldspawn != nullptr, FALSE);
+    return rmf_map_object_visit(
+        RMF_MAP_OBJECT(self->worldspawn),
+        visitor,
+        flags,
+        user_data
+    );
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
@@ -235,25 +333,55 @@ RmfRoot *rmf_root_new(RmfLoader *loader)
 
 void rmf_read_root(RmfLoader *loader, RmfRoot *self)
 {
+    self->model = rmf_model_ref(loader->model);
+
     rmf_int n_visgroups = 0;
-    rmf_read_int(loader, &n_visgroups);
-    self->visgroups
-        = g_ptr_array_new_full(n_visgroups, (GDestroyNotify)rmf_visgroup_free);
+    rmf_read_count(loader, &n_visgroups, 1);
+    // Visgroups are allocated from the load's arena.
+    self->visgroups = g_ptr_array_new_full(n_visgroups, nullptr);
 
-    rmf_loader_log_begin(
-        loader,
-        "visgroups",
-        "count",
-        "%u",
-        n_visgroups,
-        nullptr
-    );
+    RMF_TRACE_BEGIN(loader, "visgroups", "count=\"%u\"", n_visgroups);
     for (rmf_int i = 0; i < n_visgroups; ++i) {
         auto visgroup = rmf_visgroup_new(loader);
         g_ptr_array_add(self->visgroups, visgroup);
     }
-    rmf_loader_log_end(loader);
+    RMF_TRACE_END(loader);
 
-    self->worldspawn = rmf_worldspawn_new(loader);
+    auto const world = rmf_model_add_nodes(self->model, 1);
+    rmf_read_map_object(loader, world);
+    if (rmf_loader_failed(loader)) {
+        return;
+    }
+    if (rmf_model_node(self->model, world)->object_type
+        != RMF_OBJECT_TYPE_WORLD)
+    {
+        rmf_loader_fail(
+            loader,
+            RMF_LOADER_ERROR_INVALID,
+            "The top-level object is not a worldspawn"
+        );
+        return;
+    }
+    self->worldspawn = RMF_WORLDSPAWN(rmf_model_get_object(self->model, world));
     self->docinfo = rmf_docinfo_new(loader);
+
+    if (loader->scratch != nullptr && !rmf_loader_failed(loader)) {
+        self->geometry = rmf_geometry_new_for_model(self->model);
+        // Faces from the arena now point into the store.
+        rmf_arena_keep(
+            loader->arena,
+            rmf_geometry_ref(self->geometry),
+            (GDestroyNotify)rmf_geometry_unref
+        );
+    }
+
+    if ((loader->flags & RMF_LOADER_FLAGS_PLANE_TABLE)
+        && !rmf_loader_failed(loader))
+    {
+        self->plane_table = rmf_plane_table_new(
+            self->model,
+            RMF_PLANE_TABLE_NORMAL_EPSILON,
+            RMF_PLANE_TABLE_DISTANCE_EPSILON
+        );
+    }
 }
@@ -5,7 +5,11 @@
 #  error "Only <rmf.h> can be included directly."
 #endif
 
+#include "rmf/rmf-geometry.h"
+#include "rmf/rmf-model.h"
+#include "rmf/rmf-planetable.h"
 #include "rmf/rmf-structs.h"
+#include "rmf/rmf-visitor.h"
 #include "rmf/rmf-worldspawn.h"
 
 #include <glib-object.h>
@@ -32,8 +36,19 @@ G_DECLARE_FINAL_TYPE(RmfRoot, rmf_root, RMF, ROOT, GObject)
 
 rmf_int rmf_root_get_n_visgroups(RmfRoot *root);
 RmfVisgroupIterator *rmf_root_get_visgroups(RmfRoot *root);
+RmfVisgroup *const *
+rmf_root_get_visgroup_array(RmfRoot *root, guint *n_visgroups);
 RmfWorldspawn *rmf_root_get_worldspawn(RmfRoot *root);
 RmfDocinfo *rmf_root_get_docinfo(RmfRoot *root);
+RmfGeometry *rmf_root_get_geometry(RmfRoot *root);
+RmfPlaneTable *rmf_root_get_plane_table(RmfRoot *root);
+RmfModel *rmf_root_get_model(RmfRoot *root);
+gboolean rmf_root_visit(
+    RmfRoot *root,
+    RmfVisitor const *visitor,
+    RmfVisitFlags flags,
+    gpointer user_data
+);
 
 G_END_DECLS
 
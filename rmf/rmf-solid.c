@@ -37,7 +37,6 @@ RMF_DEFINE_ITERATOR_TYPE(
  */
 struct _RmfSolid {
     RmfMapObject parent_instance;
-    GPtrArray *faces;
 };
 
 enum Property {
@@ -50,18 +49,69 @@ static GParamSpec *obj_properties[N_PROPERTIES];
 
 G_DEFINE_FINAL_TYPE(RmfSolid, rmf_solid, RMF_TYPE_MAP_OBJECT)
 
-// GObject /////////////////////////////////////////////////////////////////////
+// Private /////////////////////////////////////////////////////////////////////
+
+// Free a lazily decoded face. Unlike copies, it shares its texture name.
+static void free_lazy_face(RmfFace *face)
+{
+    g_free(face->vertices);
+    g_free(face);
+}
 
-static void rmf_solid_dispose(GObject *object)
+static GPtrArray *read_faces(RmfLoader *loader, rmf_int n_faces)
 {
-    auto self = RMF_SOLID(object);
-    if (self->faces) {
-        g_ptr_array_unref(self->faces);
-        self->faces = nullptr;
+    // Faces from an arena go with it.
+    auto const free_func
+        = loader->arena ? nullptr : (GDestroyNotify)free_lazy_face;
+    auto const faces = g_ptr_array_new_full(n_faces, free_func);
+    for (rmf_int i = 0; i < n_faces; ++i) {
+        RmfFace *face = rmf_face_new(loader);
+        g_ptr_array_add(faces, face);
     }
-    G_OBJECT_CLASS(rmf_solid_parent_class)->dispose(object);
+    return faces;
 }
 
+static RmfSolidRecord *get_record(RmfSolid *self, RmfModel **model)
+{
+    auto const node = rmf_map_object_peek_node(RMF_MAP_OBJECT(self), model);
+    return *model ? rmf_model_solid(*model, node->payload) : nullptr;
+}
+
+// Get the faces, decoding them first if needed. Threads racing to decode the
+// same solid each decode a copy, and all but the first copy are dropped.
+static GPtrArray *get_faces(RmfSolid *self)
+{
+    RmfModel *model = nullptr;
+    auto const record = get_record(self, &model);
+    if (record == nullptr) {
+        return nullptr;
+    }
+    GPtrArray *faces = g_atomic_pointer_get(&record->faces);
+    if (faces != nullptr || model->data == nullptr) {
+        return faces;
+    }
+
+    g_autoptr(RmfLoader) loader = rmf_loader_new_for_data(
+        model->data,
+        model->readers,
+        model->strings,
+        record->faces_offset
+    );
+    faces = read_faces(loader, record->n_faces);
+    if (rmf_loader_failed(loader)) {
+        g_warning("Failed to decode faces: %s", loader->error->message);
+    }
+
+    if (!g_atomic_pointer_compare_and_exchange(&record->faces, nullptr, faces))
+    {
+        g_ptr_array_unref(faces);
+        faces = g_atomic_pointer_get(&record->faces);
+    }
+    return faces;
+}
+
+// GObject /////////////////////////////////////////////////////////////////////
+
 static void rmf_solid_get_property(
     GObject *object,
     guint property_id,
@@ -70,12 +120,17 @@ static void rmf_solid_get_property(
 )
 {
     auto const self = RMF_SOLID(object);
+    RmfModel *model = nullptr;
+    auto const record = get_record(self, &model);
     switch ((enum Property)property_id) {
     case PROP_N_FACES:
-        g_value_set_uint(value, self->faces->len);
+        g_value_set_uint(value, record ? record->n_faces : 0);
         break;
     case PROP_FACES:
-        g_value_take_object(value, rmf_face_iterator_new(self->faces));
+        g_value_take_object(
+            value,
+            rmf_face_iterator_new(get_faces(self), self)
+        );
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -83,39 +138,11 @@ static void rmf_solid_get_property(
     }
 }
 
-// RmfMapObject ////////////////////////////////////////////////////////////////
-
-static void rmf_solid_load(RmfMapObject *map_object, RmfLoader *loader)
-{
-    rmf_loader_log_begin(loader, "solid", nullptr);
-    RMF_MAP_OBJECT_CLASS(rmf_solid_parent_class)->load(map_object, loader);
-
-    auto const self = RMF_SOLID(map_object);
-    auto const object_type = rmf_map_object_get_object_type(map_object);
-    g_return_if_fail(object_type == RMF_OBJECT_TYPE_SOLID);
-
-    rmf_int n_faces;
-    rmf_read_int(loader, &n_faces);
-    rmf_loader_log_begin(loader, "faces", "count", "%u", n_faces, nullptr);
-
-    self->faces = g_ptr_array_new_full(n_faces, (GDestroyNotify)rmf_face_free);
-    for (rmf_int i = 0; i < n_faces; ++i) {
-        RmfFace *face = rmf_face_new(loader);
-        g_ptr_array_add(self->faces, face);
-    }
-    rmf_loader_log_end(loader);
-    rmf_loader_log_end(loader);
-}
-
 // RmfSolid ////////////////////////////////////////////////////////////////////
 
 static void rmf_solid_class_init(RmfSolidClass *klass)
 {
-    auto moclass = RMF_MAP_OBJECT_CLASS(klass);
-    moclass->load = rmf_solid_load;
-
     auto const oclass = G_OBJECT_CLASS(klass);
-    oclass->dispose = rmf_solid_dispose;
     oclass->get_property = rmf_solid_get_property;
 
     /**
@@ -165,9 +192,10 @@ static void rmf_solid_init(RmfSolid *)
  */
 rmf_int rmf_solid_get_n_faces(RmfSolid *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "n-faces", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_SOLID(self), 0);
+    RmfModel *model = nullptr;
+    auto const record = get_record(self, &model);
+    return record ? record->n_faces : 0;
 }
 
 /**
@@ -176,20 +204,98 @@ rmf_int rmf_solid_get_n_faces(RmfSolid *self)
  *
  * Gets the faces which make up the solid.
  *
+ * If the solid was loaded with [flags@RmfLoaderFlags.LAZY_FACES], the faces are
+ * decoded on the first call.
+ *
  * Returns: (transfer full): Iterator over the [struct@RmfFace]s of the solid.
  */
 RmfFaceIterator *rmf_solid_get_faces(RmfSolid *self)
 {
-    RmfFaceIterator *value = nullptr;
-    g_object_get(self, "faces", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_SOLID(self), nullptr);
+    return rmf_face_iterator_new(get_faces(self), self);
+}
+
+/**
+ * rmf_solid_get_face_array:
+ * @solid: The solid
+ * @n_faces: (out): Return location for the number of faces.
+ *
+ * Gets the faces which make up the solid as an array, without making an
+ * iterator. Faces are decoded first, like with [method@RmfSolid.get_faces].
+ *
+ * Returns: (transfer none) (array length=n_faces) (nullable): The faces, valid
+ * as long as the solid, or until [method@RmfSolid.evict_faces] is called.
+ */
+RmfFace *const *rmf_solid_get_face_array(RmfSolid *self, guint *n_faces)
+{
+    g_return_val_if_fail(RMF_IS_SOLID(self), nullptr);
+    g_return_val_if_fail(n_faces != nullptr, nullptr);
+    return (RmfFace *const *)rmf_ptr_array_span(get_faces(self), n_faces);
+}
+
+/**
+ * rmf_solid_evict_faces:
+ * @solid: The solid
+ *
+ * Drops the decoded faces of a solid loaded with
+ * [flags@RmfLoaderFlags.LAZY_FACES], to be decoded again when next asked for.
+ * Iterators from [method@RmfSolid.get_faces] keep their faces alive.
+ *
+ * Does nothing for solids which were not loaded lazily. Must not be called
+ * while another thread is getting the faces of the same solid.
+ */
+void rmf_solid_evict_faces(RmfSolid *self)
+{
+    g_return_if_fail(RMF_IS_SOLID(self));
+    RmfModel *model = nullptr;
+    auto const record = get_record(self, &model);
+    if (record == nullptr || model->data == nullptr) {
+        return;
+    }
+    GPtrArray *faces = g_atomic_pointer_exchange(&record->faces, nullptr);
+    if (faces != nullptr) {
+        g_ptr_array_unref(faces);
+    }
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-RmfSolid *rmf_solid_new(RmfLoader *loader)
+rmf_int rmf_solid_read(RmfLoader *loader)
 {
-    RmfSolid *self = g_object_new(RMF_TYPE_SOLID, nullptr);
-    rmf_solid_load(RMF_MAP_OBJECT(self), loader);
-    return self;
+    auto const model = loader->model;
+    auto const index = model->solids->len;
+    g_array_set_size(model->solids, index + 1);
+    auto const record = rmf_model_solid(model, index);
+
+    rmf_read_count(loader, &record->n_faces, 1);
+    RMF_TRACE_BEGIN(loader, "faces", "count=\"%u\"", record->n_faces);
+
+    rmf_bounds_clear(&record->bounds);
+    if (model->data != nullptr) {
+        record->faces_offset = rmf_loader_get_offset(loader);
+        for (rmf_int i = 0; i < record->n_faces; ++i) {
+            rmf_skip_face(loader, &record->bounds);
+        }
+    } else {
+        record->faces = read_faces(loader, record->n_faces);
+        for (guint i = 0; i < record->faces->len; ++i) {
+            RmfFace const *face = g_ptr_array_index(record->faces, i);
+            rmf_bounds_add_points(
+                &record->bounds,
+                face->vertices,
+                face->n_vertices
+            );
+        }
+    }
+    RMF_TRACE_END(loader);
+    return index;
+}
+
+void rmf_solid_skip(RmfLoader *loader)
+{
+    rmf_int n_faces = 0;
+    rmf_read_count(loader, &n_faces, 1);
+    for (rmf_int i = 0; i < n_faces && !rmf_loader_failed(loader); ++i) {
+        rmf_skip_face(loader, nullptr);
+    }
 }
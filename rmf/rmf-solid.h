@@ -32,6 +32,8 @@ G_DECLARE_FINAL_TYPE(RmfSolid, rmf_solid, RMF, SOLID, RmfMapObject);
 
 rmf_int rmf_solid_get_n_faces(RmfSolid *solid);
 RmfFaceIterator *rmf_solid_get_faces(RmfSolid *solid);
+RmfFace *const *rmf_solid_get_face_array(RmfSolid *solid, guint *n_faces);
+void rmf_solid_evict_faces(RmfSolid *solid);
 
 G_END_DECLS
 
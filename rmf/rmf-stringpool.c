@@ -0,0 +1,124 @@
+#include "rmf/rmf-stringpool.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfStringPool:
+ *
+ * A thread-safe set of interned strings.
+ *
+ * Classnames, keys and texture names repeat a lot within a map, and across
+ * maps. Loaded records point into a pool instead of holding their own copies,
+ * so equal strings are stored once and can be compared by pointer.
+ *
+ * Each load interns into a new pool, unless one is set with
+ * [method@RmfLoader.set_string_pool] to be shared between loads. Interned
+ * strings live as long as the pool.
+ */
+struct _RmfStringPool {
+    GMutex mutex;
+    GHashTable *strings; // Set of the interned strings.
+    RmfArena *arena;     // Holds the bytes of the interned strings.
+};
+
+G_DEFINE_BOXED_TYPE(
+    RmfStringPool,
+    rmf_string_pool,
+    rmf_string_pool_ref,
+    rmf_string_pool_unref
+)
+
+static void string_pool_clear(RmfStringPool *self)
+{
+    g_hash_table_unref(self->strings);
+    rmf_arena_unref(self->arena);
+    g_mutex_clear(&self->mutex);
+}
+
+/**
+ * rmf_string_pool_new:
+ *
+ * Creates a new, empty [struct@RmfStringPool].
+ *
+ * Returns: (transfer full): The new pool.
+ */
+RmfStringPool *rmf_string_pool_new(void)
+{
+    RmfStringPool *self = g_atomic_rc_box_new0(RmfStringPool);
+    g_mutex_init(&self->mutex);
+    self->strings = g_hash_table_new(g_str_hash, g_str_equal);
+    self->arena = rmf_arena_new();
+    return self;
+}
+
+/**
+ * rmf_string_pool_ref:
+ * @pool: The pool.
+ *
+ * Increases the reference count of a pool.
+ *
+ * Returns: (transfer full): The pool.
+ */
+RmfStringPool *rmf_string_pool_ref(RmfStringPool *self)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    return g_atomic_rc_box_acquire(self);
+}
+
+/**
+ * rmf_string_pool_unref:
+ * @pool: (transfer full): The pool.
+ *
+ * Decreases the reference count of a pool, freeing it and all of its strings
+ * when it reaches zero.
+ */
+void rmf_string_pool_unref(RmfStringPool *self)
+{
+    g_return_if_fail(self != nullptr);
+    g_atomic_rc_box_release_full(self, (GDestroyNotify)string_pool_clear);
+}
+
+/**
+ * rmf_string_pool_intern:
+ * @pool: The pool.
+ * @string: The string to intern.
+ *
+ * Gets the pool's copy of a string, adding it if needed.
+ *
+ * Returns: (transfer none): The interned string, which stays valid as long as
+ * the pool.
+ */
+char const *rmf_string_pool_intern(RmfStringPool *self, char const *string)
+{
+    g_return_val_if_fail(self != nullptr, nullptr);
+    g_return_val_if_fail(string != nullptr, nullptr);
+
+    g_mutex_lock(&self->mutex);
+    char *interned = g_hash_table_lookup(self->strings, string);
+    if (interned == nullptr) {
+        interned = rmf_arena_strndup(self->arena, string, strlen(string));
+        g_hash_table_add(self->strings, interned);
+    }
+    g_mutex_unlock(&self->mutex);
+    return interned;
+}
+
+/**
+ * rmf_string_pool_get_n_strings:
+ * @pool: The pool.
+ *
+ * Gets the number of distinct strings in the pool.
+ *
+ * Returns: The number of strings.
+ */
+guint rmf_string_pool_get_n_strings(RmfStringPool *self)
+{
+    g_return_val_if_fail(self != nullptr, 0);
+    g_mutex_lock(&self->mutex);
+    auto const n_strings = g_hash_table_size(self->strings);
+    g_mutex_unlock(&self->mutex);
+    return n_strings;
+}
@@ -0,0 +1,29 @@
+#ifndef RMF_STRING_POOL_H
+#define RMF_STRING_POOL_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfStringPool
+
+#define RMF_TYPE_STRING_POOL rmf_string_pool_get_type()
+
+typedef struct _RmfStringPool RmfStringPool;
+
+GType rmf_string_pool_get_type(void);
+RmfStringPool *rmf_string_pool_new(void);
+RmfStringPool *rmf_string_pool_ref(RmfStringPool *pool);
+void rmf_string_pool_unref(RmfStringPool *pool);
+char const *rmf_string_pool_intern(RmfStringPool *pool, char const *string);
+guint rmf_string_pool_get_n_strings(RmfStringPool *pool);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(RmfStringPool, rmf_string_pool_unref)
+
+G_END_DECLS
+
+#endif
@@ -32,23 +32,24 @@ void rmf_read_visgroup(RmfLoader *self, RmfVisgroup *visgroup)
     visgroup->visible = visible == 0;
     rmf_loader_seek(self, 3);
 
-    rmf_loader_log_oneline(
+    RMF_TRACE_ONELINE(
         self,
         "visgroup",
         nullptr,
-        "name",
-        "%s",
+        "name=\"%s\" id=\"%u\"",
         visgroup->name,
-        "id",
-        "%u",
-        visgroup->visgroup_id,
-        nullptr
+        visgroup->visgroup_id
     );
 }
 
+void rmf_skip_visgroup(RmfLoader *self)
+{
+    rmf_loader_seek(self, 128 + sizeof(RmfColor) + 1 + 4 + 1 + 3);
+}
+
 RmfVisgroup *rmf_visgroup_new(RmfLoader *loader)
 {
-    auto const self = g_new(RmfVisgroup, 1);
+    RmfVisgroup *self = rmf_loader_alloc(loader, sizeof(RmfVisgroup));
     rmf_read_visgroup(loader, self);
     return self;
 }
@@ -67,8 +68,8 @@ void rmf_visgroup_free(RmfVisgroup *self)
 
 /**
  * RmfFace:
- * @texture_name: Name of the texture applied to the
- * face.
+ * @texture_name: Name of the texture applied to the face. Interned in the
+ *   [struct@RmfStringPool] of the load.
  * @right_axis: Projected right axis for texture application.
  * @shift_x: Horizontal shift of the texture
  * @down_axis: Projected down axis for texture application.
@@ -76,7 +77,9 @@ void rmf_visgroup_free(RmfVisgroup *self)
  * @angle: Rotation applied to the right and down axes.
  * @scale_x: Horizontal scaling multiplier.
  * @scale_y: Vertical scaling multiplier.
- * @vertices: (element-type RmfVector): The vertices which make up the polygon.
+ * @vertices: (array length=n_vertices): The vertices which make up the polygon.
+ *   They point into the map's [struct@RmfGeometry], if it has one.
+ * @n_vertices: Number of @vertices.
  * @plane_points: A triple of points which define the face's 3D plane.
  *
  * A flat polygon, used to define the 3D space which makes up a
@@ -84,55 +87,122 @@ void rmf_visgroup_free(RmfVisgroup *self)
  */
 G_DEFINE_BOXED_TYPE(RmfFace, rmf_face, rmf_face_copy, rmf_face_free)
 
-void rmf_read_face(RmfLoader *self, RmfFace *face)
+// Shared tail of the versioned face readers.
+static void read_face_polygon(RmfLoader *self, RmfFace *face)
 {
-    auto const RMF_VERSION = rmf_loader_get_version(self);
+    rmf_int n_vertices = 0;
+    rmf_read_count(self, &n_vertices, sizeof(RmfVector));
+
+    RMF_TRACE_ONELINE(self, "face", nullptr, "n_vertices=\"%u\"", n_vertices);
 
-    rmf_loader_read(self, RMF_VERSION > 1.6f ? 256 : 36, face->texture_name);
-    rmf_loader_seek(self, 4);
-    if (RMF_VERSION >= 2.2f) {
-        rmf_read_vector(self, &face->right_axis);
+    face->vertices = rmf_loader_alloc_vertices(self, n_vertices);
+    face->n_vertices = n_vertices;
+    rmf_loader_read(self, n_vertices * sizeof(RmfVector), face->vertices);
+    rmf_loader_read(self, 3 * sizeof(RmfVector), face->plane_points);
+}
+
+// The fixed-size part of a face is consumed in one go and picked apart at
+// constant offsets. These fields are contiguous in both the file and RmfFace.
+static_assert(offsetof(RmfFace, scale_y) - offsetof(RmfFace, shift_y) == 12);
+static_assert(offsetof(RmfFace, scale_y) - offsetof(RmfFace, right_axis) == 40);
+
+// TODO: Compute right_axis and down_axis for versions before 2.2. See
+// https://github.com/id-Software/Quake-Tools/blob/master/qutils/QBSP/MAP.C
+// for details.
+
+// RMF 1.6: 36-byte texture name, no texture axes.
+static void read_face_v16(RmfLoader *self, RmfFace *face)
+{
+    auto const p = rmf_loader_take(self, self->readers->face_size);
+    *face = (RmfFace){};
+    if (G_LIKELY(p != nullptr)) {
+        face->texture_name = rmf_loader_intern(self, p, 36);
+        memcpy(&face->shift_x, p + 40, 4);
+        memcpy(&face->shift_y, p + 44, 16);
+    }
+    read_face_polygon(self, face);
+}
+
+// RMF 1.8 through 2.1: 256-byte texture name, no texture axes.
+static void read_face_v18(RmfLoader *self, RmfFace *face)
+{
+    auto const p = rmf_loader_take(self, self->readers->face_size);
+    if (G_LIKELY(p != nullptr)) {
+        face->texture_name = rmf_loader_intern(self, p, 256);
+        face->right_axis = (RmfVector){};
+        memcpy(&face->shift_x, p + 260, 4);
+        face->down_axis = (RmfVector){};
+        memcpy(&face->shift_y, p + 264, 16);
     } else {
-        // TODO: Compute right_axis. See
-        // https://github.com/id-Software/Quake-Tools/blob/master/qutils/QBSP/MAP.C
-        // for details.
+        *face = (RmfFace){};
     }
-    rmf_read_float(self, &face->shift_x);
-    if (RMF_VERSION >= 2.2f) {
-        rmf_read_vector(self, &face->down_axis);
+    read_face_polygon(self, face);
+}
+
+// RMF 2.2: 256-byte texture name, with texture axes.
+static void read_face_v22(RmfLoader *self, RmfFace *face)
+{
+    auto const p = rmf_loader_take(self, self->readers->face_size);
+    if (G_LIKELY(p != nullptr)) {
+        face->texture_name = rmf_loader_intern(self, p, 256);
+        memcpy(&face->right_axis, p + 260, 44);
     } else {
-        // TODO: Compute down_axis. See
-        // https://github.com/id-Software/Quake-Tools/blob/master/qutils/QBSP/MAP.C
-        // for details.
+        *face = (RmfFace){};
     }
-    rmf_read_float(self, &face->shift_y);
-    rmf_read_float(self, &face->angle);
-    rmf_read_float(self, &face->scale_x);
-    rmf_read_float(self, &face->scale_y);
-    rmf_loader_seek(self, RMF_VERSION > 1.6f ? 16 : 4);
-    rmf_int n_vertices = 0;
-    rmf_read_int(self, &n_vertices);
+    read_face_polygon(self, face);
+}
 
-    rmf_loader_log_oneline(
-        self,
-        "face",
-        nullptr,
-        "n_vertices",
-        "%u",
-        n_vertices,
-        nullptr
-    );
+RmfReaders const *rmf_readers_for_version(rmf_float version)
+{
+    static RmfReaders const readers_v16 = {
+        .read_face = read_face_v16,
+        .face_size = 36 + 4 + 20 + 4,
+    };
+    static RmfReaders const readers_v18 = {
+        .read_face = read_face_v18,
+        .face_size = 256 + 4 + 20 + 16,
+    };
+    static RmfReaders const readers_v22 = {
+        .read_face = read_face_v22,
+        .face_size = 256 + 4 + 44 + 16,
+    };
+
+    if (version <= 1.6f) {
+        return &readers_v16;
+    } else if (version < 2.2f) {
+        return &readers_v18;
+    } else {
+        return &readers_v22;
+    }
+}
 
-    auto const vertices = g_new(RmfVector, n_vertices);
-    rmf_loader_read(self, n_vertices * sizeof(RmfVector), vertices);
-    face->vertices
-        = g_array_new_take(vertices, n_vertices, FALSE, sizeof(RmfVector));
-    rmf_loader_read(self, 3 * sizeof(RmfVector), face->plane_points);
+void rmf_read_face(RmfLoader *self, RmfFace *face)
+{
+    self->readers->read_face(self, face);
+}
+
+// Skip a face by its vertex count. The vertices are only looked at to grow
+// @bounds, if given.
+void rmf_skip_face(RmfLoader *self, RmfBounds *bounds)
+{
+    rmf_loader_seek(self, self->readers->face_size);
+    rmf_int n_vertices = 0;
+    rmf_read_count(self, &n_vertices, sizeof(RmfVector));
+    if (bounds != nullptr) {
+        auto const size = n_vertices * sizeof(RmfVector);
+        auto const vertices = rmf_loader_take(self, size);
+        if (vertices != nullptr) {
+            rmf_bounds_add_points(bounds, vertices, n_vertices);
+        }
+        rmf_loader_seek(self, 3 * sizeof(RmfVector));
+    } else {
+        rmf_loader_seek(self, (n_vertices + 3) * sizeof(RmfVector));
+    }
 }
 
 RmfFace *rmf_face_new(RmfLoader *loader)
 {
-    auto const self = g_new(RmfFace, 1);
+    RmfFace *self = rmf_loader_alloc(loader, sizeof(RmfFace));
     rmf_read_face(loader, self);
     return self;
 }
@@ -141,19 +211,22 @@ RmfFace *rmf_face_copy(RmfFace const *self)
 {
     auto const copy = g_new(RmfFace, 1);
     memcpy(copy, self, sizeof(RmfFace));
-    copy->vertices = g_array_ref(self->vertices);
+    copy->texture_name = g_strdup(self->texture_name);
+    copy->vertices
+        = g_memdup2(self->vertices, self->n_vertices * sizeof(RmfVector));
     return copy;
 }
 
 void rmf_face_free(RmfFace *self)
 {
-    g_array_unref(self->vertices);
+    g_free((gpointer)self->texture_name);
+    g_free(self->vertices);
     g_free(self);
 }
 
 /**
  * RmfKeyvalue:
- * @key: Key name.
+ * @key: Key name. Interned in the [struct@RmfStringPool] of the load.
  * @value: Value string.
  *
  * A key-value pair, stored as strings.
@@ -167,35 +240,53 @@ G_DEFINE_BOXED_TYPE(
 
 void rmf_read_keyvalue(RmfLoader *self, RmfKeyvalue *keyvalue)
 {
-    rmf_read_nstring(self, &keyvalue->key);
-    rmf_read_nstring(self, &keyvalue->value);
-    rmf_loader_log_oneline(
+    keyvalue->key = rmf_read_interned_nstring(self);
+    keyvalue->value = rmf_read_copied_nstring(self);
+    RMF_TRACE_ONELINE(
         self,
         "keyvalue",
-        keyvalue->value.data,
-        "key",
-        "%s",
-        keyvalue->key.data,
-        nullptr
+        keyvalue->value,
+        "key=\"%s\"",
+        keyvalue->key
     );
 }
 
+void rmf_skip_keyvalue(RmfLoader *self)
+{
+    rmf_skip_nstring(self);
+    rmf_skip_nstring(self);
+}
+
 RmfKeyvalue *rmf_keyvalue_new(RmfLoader *loader)
 {
-    auto const self = g_new(RmfKeyvalue, 1);
+    RmfKeyvalue *self = rmf_loader_alloc(loader, sizeof(RmfKeyvalue));
     rmf_read_keyvalue(loader, self);
     return self;
 }
 
+// Copy the strings of @src to the heap.
+static void keyvalue_copy_into(RmfKeyvalue *dest, RmfKeyvalue const *src)
+{
+    dest->key = g_strdup(src->key);
+    dest->value = g_strdup(src->value);
+}
+
+static void keyvalue_clear(RmfKeyvalue *self)
+{
+    g_free((gpointer)self->key);
+    g_free((gpointer)self->value);
+}
+
 RmfKeyvalue *rmf_keyvalue_copy(RmfKeyvalue const *self)
 {
     auto const copy = g_new(RmfKeyvalue, 1);
-    memcpy(copy, self, sizeof(RmfKeyvalue));
+    keyvalue_copy_into(copy, self);
     return copy;
 }
 
 void rmf_keyvalue_free(RmfKeyvalue *self)
 {
+    keyvalue_clear(self);
     g_free(self);
 }
 
@@ -221,7 +312,7 @@ void rmf_read_pathnode(RmfLoader *self, RmfPathNode *pathnode)
     rmf_read_int(self, &pathnode->index);
     rmf_loader_read(self, 128, pathnode->name_override);
     rmf_int n_keyvalues = 0;
-    rmf_read_int(self, &n_keyvalues);
+    rmf_read_count(self, &n_keyvalues, 4);
     pathnode->keyvalues
         = g_array_sized_new(FALSE, FALSE, sizeof(RmfKeyvalue), n_keyvalues);
     for (rmf_int i = 0; i < n_keyvalues; ++i) {
@@ -242,7 +333,19 @@ RmfPathNode *rmf_path_node_copy(RmfPathNode *self)
 {
     auto const copy = g_new(RmfPathNode, 1);
     memcpy(copy, self, sizeof(RmfPathNode));
-    copy->keyvalues = g_array_ref(self->keyvalues);
+
+    // The loaded strings go with the load, so copy them.
+    auto const n_keyvalues = self->keyvalues->len;
+    copy->keyvalues
+        = g_array_sized_new(FALSE, FALSE, sizeof(RmfKeyvalue), n_keyvalues);
+    g_array_set_clear_func(copy->keyvalues, (GDestroyNotify)keyvalue_clear);
+    g_array_set_size(copy->keyvalues, n_keyvalues);
+    for (guint i = 0; i < n_keyvalues; ++i) {
+        keyvalue_copy_into(
+            &g_array_index(copy->keyvalues, RmfKeyvalue, i),
+            &g_array_index(self->keyvalues, RmfKeyvalue, i)
+        );
+    }
     return copy;
 }
 
@@ -269,7 +372,7 @@ void rmf_read_path(RmfLoader *self, RmfPath *path)
     rmf_loader_read(self, 128, &path->classname);
     rmf_read_int(self, &path->path_type);
     rmf_int n_nodes;
-    rmf_read_int(self, &n_nodes);
+    rmf_read_count(self, &n_nodes, 1);
     path->nodes
         = g_ptr_array_new_full(n_nodes, (GDestroyNotify)rmf_path_node_free);
     for (rmf_int i = 0; i < n_nodes; ++i) {
@@ -278,6 +381,21 @@ void rmf_read_path(RmfLoader *self, RmfPath *path)
     }
 }
 
+void rmf_skip_path(RmfLoader *self)
+{
+    rmf_loader_seek(self, 128 + 128 + 4);
+    rmf_int n_nodes = 0;
+    rmf_read_count(self, &n_nodes, 1);
+    for (rmf_int i = 0; i < n_nodes && !rmf_loader_failed(self); ++i) {
+        rmf_loader_seek(self, sizeof(RmfVector) + 4 + 128);
+        rmf_int n_keyvalues = 0;
+        rmf_read_count(self, &n_keyvalues, 4);
+        for (rmf_int j = 0; j < n_keyvalues; ++j) {
+            rmf_skip_keyvalue(self);
+        }
+    }
+}
+
 RmfPath *rmf_path_new(RmfLoader *loader)
 {
     auto const self = g_new(RmfPath, 1);
@@ -289,7 +407,12 @@ RmfPath *rmf_path_copy(RmfPath *self)
 {
     auto const copy = g_new(RmfPath, 1);
     memcpy(copy, self, sizeof(RmfPath));
-    copy->nodes = g_ptr_array_ref(self->nodes);
+    copy->nodes = g_ptr_array_copy(
+        self->nodes,
+        (GCopyFunc)rmf_path_node_copy,
+        nullptr
+    );
+    g_ptr_array_set_free_func(copy->nodes, (GDestroyNotify)rmf_path_node_free);
     return copy;
 }
 
@@ -311,30 +434,18 @@ G_DEFINE_BOXED_TYPE(RmfCamera, rmf_camera, rmf_camera_copy, rmf_camera_free)
 void rmf_read_camera(RmfLoader *self, RmfCamera *camera)
 {
     rmf_loader_read(self, sizeof(RmfCamera), camera);
-    g_autofree auto eyestr = g_strdup_printf(
-        "%g %g %g",
+    RMF_TRACE_ONELINE(
+        self,
+        "camera",
+        nullptr,
+        "eye=\"%g %g %g\" lookat=\"%g %g %g\"",
         camera->eye_position.x,
         camera->eye_position.y,
-        camera->eye_position.z
-    );
-    g_autofree auto lookstr = g_strdup_printf(
-        "%g %g %g",
+        camera->eye_position.z,
         camera->lookat_position.x,
         camera->lookat_position.y,
         camera->lookat_position.z
     );
-    rmf_loader_log_oneline(
-        self,
-        "camera",
-        nullptr,
-        "eye",
-        "%s",
-        eyestr,
-        "lookat",
-        "%s",
-        lookstr,
-        nullptr
-    );
 }
 
 RmfCamera *rmf_camera_new(RmfLoader *loader)
@@ -375,22 +486,18 @@ void rmf_read_docinfo(RmfLoader *self, RmfDocinfo *docinfo)
     rmf_read_float(self, &docinfo->docinfo_version);
     rmf_read_int(self, &docinfo->active_camera);
 
-    rmf_loader_log_begin(
+    RMF_TRACE_BEGIN(
         self,
         "docinfo",
-        "version",
-        "%g",
+        "version=\"%g\" active_camera=\"%u\"",
         docinfo->docinfo_version,
-        "active_camera",
-        "%u",
-        docinfo->active_camera,
-        nullptr
+        docinfo->active_camera
     );
 
     rmf_int n_cameras = 0;
-    rmf_read_int(self, &n_cameras);
+    rmf_read_count(self, &n_cameras, sizeof(RmfCamera));
 
-    rmf_loader_log_begin(self, "cameras", "count", "%u", n_cameras, nullptr);
+    RMF_TRACE_BEGIN(self, "cameras", "count=\"%u\"", n_cameras);
 
     docinfo->cameras
         = g_array_sized_new(FALSE, FALSE, sizeof(RmfCamera), n_cameras);
@@ -400,8 +507,8 @@ void rmf_read_docinfo(RmfLoader *self, RmfDocinfo *docinfo)
         g_array_append_val(docinfo->cameras, camera);
     }
 
-    rmf_loader_log_end(self);
-    rmf_loader_log_end(self);
+    RMF_TRACE_END(self);
+    RMF_TRACE_END(self);
 }
 
 RmfDocinfo *rmf_docinfo_new(RmfLoader *loader)
@@ -30,7 +30,7 @@ void rmf_visgroup_free(RmfVisgroup *self);
 #define RMF_TYPE_FACE rmf_face_get_type()
 
 typedef struct {
-    char texture_name[256]; // Until RMF v1.8: 36 bytes long
+    char const *texture_name; // Until RMF v1.8: at most 35 characters long
     RmfVector right_axis;   // Since RMF v2.2
     rmf_float shift_x;
     RmfVector down_axis; // Since RMF v2.2
@@ -38,7 +38,8 @@ typedef struct {
     rmf_float angle;
     rmf_float scale_x;
     rmf_float scale_y;
-    GArray *vertices;
+    RmfVector *vertices;
+    rmf_int n_vertices;
     RmfVector plane_points[3];
 } RmfFace;
 
@@ -51,8 +52,8 @@ void rmf_face_free(RmfFace *self);
 #define RMF_TYPE_KEYVALUE rmf_keyvalue_get_type()
 
 typedef struct {
-    rmf_nstring key;
-    rmf_nstring value;
+    char const *key;
+    char const *value;
 } RmfKeyvalue;
 
 GType rmf_keyvalue_get_type(void);
@@ -0,0 +1,367 @@
+#include "rmf/rmf-trace.h"
+
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <string.h>
+
+/**
+ * RmfTraceKind:
+ * @RMF_TRACE_KIND_BEGIN: A record was opened. Matched by a later
+ *   @RMF_TRACE_KIND_END.
+ * @RMF_TRACE_KIND_ONELINE: A self-contained record.
+ * @RMF_TRACE_KIND_END: The innermost open record was closed.
+ *
+ * Kinds of [struct@RmfTraceRecord].
+ */
+G_DEFINE_ENUM_TYPE(
+    RmfTraceKind,
+    rmf_trace_kind,
+    G_DEFINE_ENUM_VALUE(RMF_TRACE_KIND_BEGIN, "begin"),
+    G_DEFINE_ENUM_VALUE(RMF_TRACE_KIND_ONELINE, "oneline"),
+    G_DEFINE_ENUM_VALUE(RMF_TRACE_KIND_END, "end")
+)
+
+/**
+ * RmfTraceRecord:
+ * @kind: What kind of record this is.
+ * @source: Name of the data source being loaded.
+ * @offset: Byte offset into the data at the time of the record.
+ * @depth: Number of records enclosing this one.
+ * @tag: Name of the record, eg. `solid` or `keyvalue`.
+ * @attributes: (nullable): Formatted attributes, eg. `count="6"`. Only set if
+ *   the sink [method@RmfTraceSink.wants_text].
+ * @content: (nullable): Text content of a @RMF_TRACE_KIND_ONELINE record. Only
+ *   set if the sink [method@RmfTraceSink.wants_text].
+ *
+ * One event emitted by a [class@RmfLoader] while parsing.
+ */
+
+// RmfTraceSink ////////////////////////////////////////////////////////////////
+
+/**
+ * RmfTraceSink:
+ *
+ * Receives a structured trace of everything a [class@RmfLoader] parses.
+ *
+ * Install a sink with [method@RmfLoader.set_trace_sink]. While no sink is
+ * installed, tracing costs a pointer check per record.
+ */
+G_DEFINE_INTERFACE(RmfTraceSink, rmf_trace_sink, G_TYPE_OBJECT)
+
+static gboolean rmf_trace_sink_real_wants_text(RmfTraceSink *)
+{
+    return TRUE;
+}
+
+static void rmf_trace_sink_default_init(RmfTraceSinkInterface *iface)
+{
+    iface->wants_text = rmf_trace_sink_real_wants_text;
+}
+
+/**
+ * rmf_trace_sink_record: (virtual record):
+ * @sink: The sink.
+ * @record: The record.
+ *
+ * Hand a record to the sink.
+ */
+void rmf_trace_sink_record(RmfTraceSink *sink, RmfTraceRecord const *record)
+{
+    g_return_if_fail(RMF_IS_TRACE_SINK(sink));
+    g_return_if_fail(record != nullptr);
+    auto const iface = RMF_TRACE_SINK_GET_IFACE(sink);
+    g_return_if_fail(iface->record != nullptr);
+    iface->record(sink, record);
+}
+
+/**
+ * rmf_trace_sink_wants_text: (virtual wants_text):
+ * @sink: The sink.
+ *
+ * Whether the sink uses the formatted @attributes and @content of records.
+ * Sinks which don't spare the loader from formatting them.
+ *
+ * Returns: `TRUE` if records should carry formatted text.
+ */
+gboolean rmf_trace_sink_wants_text(RmfTraceSink *sink)
+{
+    g_return_val_if_fail(RMF_IS_TRACE_SINK(sink), FALSE);
+    auto const iface = RMF_TRACE_SINK_GET_IFACE(sink);
+    return iface->wants_text(sink);
+}
+
+// RmfXmlTraceSink /////////////////////////////////////////////////////////////
+
+/**
+ * RmfXmlTraceSink:
+ *
+ * An [iface@RmfTraceSink] which logs an indented XML outline of the data
+ * through `g_info()`, one line per record.
+ */
+struct _RmfXmlTraceSink {
+    GObject parent_instance;
+};
+
+static void rmf_xml_trace_sink_iface_init(RmfTraceSinkInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(
+    RmfXmlTraceSink,
+    rmf_xml_trace_sink,
+    G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(RMF_TYPE_TRACE_SINK, rmf_xml_trace_sink_iface_init)
+)
+
+static void
+rmf_xml_trace_sink_record(RmfTraceSink *, RmfTraceRecord const *record)
+{
+    constexpr unsigned int INDENT_WIDTH = 2;
+
+    auto const indent = (int)(record->depth * INDENT_WIDTH);
+    auto const attributes = record->attributes ? record->attributes : "";
+    auto const space = record->attributes ? " " : "";
+
+    switch (record->kind) {
+    case RMF_TRACE_KIND_BEGIN:
+        g_info(
+            "%s+%08" G_GOFFSET_MODIFIER "x: %*s<%s%s%s>",
+            record->source,
+            record->offset,
+            indent,
+            "",
+            record->tag,
+            space,
+            attributes
+        );
+        break;
+    case RMF_TRACE_KIND_ONELINE:
+        if (record->content == nullptr) {
+            g_info(
+                "%s+%08" G_GOFFSET_MODIFIER "x: %*s<%s%s%s/>",
+                record->source,
+                record->offset,
+                indent,
+                "",
+                record->tag,
+                space,
+                attributes
+            );
+        } else {
+            g_info(
+                "%s+%08" G_GOFFSET_MODIFIER "x: %*s<%s%s%s>%s</%s>",
+                record->source,
+                record->offset,
+                indent,
+                "",
+                record->tag,
+                space,
+                attributes,
+                record->content,
+                record->tag
+            );
+        }
+        break;
+    case RMF_TRACE_KIND_END:
+        g_info(
+            "%s+%08" G_GOFFSET_MODIFIER "x: %*s</%s>",
+            record->source,
+            record->offset,
+            indent,
+            "",
+            record->tag
+        );
+        break;
+    }
+}
+
+static void rmf_xml_trace_sink_iface_init(RmfTraceSinkInterface *iface)
+{
+    iface->record = rmf_xml_trace_sink_record;
+}
+
+static void rmf_xml_trace_sink_class_init(RmfXmlTraceSinkClass *)
+{
+}
+
+static void rmf_xml_trace_sink_init(RmfXmlTraceSink *)
+{
+}
+
+/**
+ * rmf_xml_trace_sink_new:
+ *
+ * Creates a new [class@RmfXmlTraceSink].
+ *
+ * Returns: The new [class@RmfXmlTraceSink].
+ */
+RmfXmlTraceSink *rmf_xml_trace_sink_new(void)
+{
+    return g_object_new(RMF_TYPE_XML_TRACE_SINK, nullptr);
+}
+
+// RmfBinaryTraceSink //////////////////////////////////////////////////////////
+
+/**
+ * RmfBinaryTraceSink:
+ *
+ * An [iface@RmfTraceSink] which writes a compact binary record stream.
+ *
+ * Each record is written as the following little-endian fields:
+ *
+ * | Size | Field                                |
+ * |------|--------------------------------------|
+ * | 8    | Byte offset                          |
+ * | 1    | [enum@RmfTraceKind]                  |
+ * | 1    | Reserved, always zero                |
+ * | 2    | Depth                                |
+ * | 2    | Tag length                           |
+ * | n    | Tag, without a terminating null byte |
+ *
+ * Attributes and content are never formatted for this sink. Writes are not
+ * buffered, so wrap the stream in a `GBufferedOutputStream` if needed. The
+ * sink stops writing after the first write error.
+ */
+struct _RmfBinaryTraceSink {
+    GObject parent_instance;
+    GOutputStream *stream;
+    bool failed;
+};
+
+enum Property {
+    PROP_STREAM = 1,
+    N_PROPERTIES,
+};
+
+static GParamSpec *obj_properties[N_PROPERTIES];
+
+static void rmf_binary_trace_sink_iface_init(RmfTraceSinkInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(
+    RmfBinaryTraceSink,
+    rmf_binary_trace_sink,
+    G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(
+        RMF_TYPE_TRACE_SINK,
+        rmf_binary_trace_sink_iface_init
+    )
+)
+
+static void rmf_binary_trace_sink_dispose(GObject *object)
+{
+    auto const self = RMF_BINARY_TRACE_SINK(object);
+    g_clear_object(&self->stream);
+    G_OBJECT_CLASS(rmf_binary_trace_sink_parent_class)->dispose(object);
+}
+
+static void rmf_binary_trace_sink_set_property(
+    GObject *object,
+    guint property_id,
+    GValue const *value,
+    GParamSpec *pspec
+)
+{
+    auto const self = RMF_BINARY_TRACE_SINK(object);
+    switch ((enum Property)property_id) {
+    case PROP_STREAM:
+        g_clear_object(&self->stream);
+        self->stream = g_value_dup_object(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+        break;
+    }
+}
+
+static void
+rmf_binary_trace_sink_record(RmfTraceSink *sink, RmfTraceRecord const *record)
+{
+    auto const self = RMF_BINARY_TRACE_SINK(sink);
+    if (self->failed || self->stream == nullptr) {
+        return;
+    }
+
+    auto const tag_length = MIN(strlen(record->tag), G_MAXUINT16);
+
+    guint8 header[14];
+    guint64 const offset = GUINT64_TO_LE(record->offset);
+    guint16 const depth = GUINT16_TO_LE(MIN(record->depth, G_MAXUINT16));
+    guint16 const length = GUINT16_TO_LE(tag_length);
+    memcpy(header + 0, &offset, 8);
+    header[8] = record->kind;
+    header[9] = 0;
+    memcpy(header + 10, &depth, 2);
+    memcpy(header + 12, &length, 2);
+
+    g_autoptr(GError) error = nullptr;
+    if (!g_output_stream_write_all(
+            self->stream,
+            header,
+            sizeof(header),
+            nullptr,
+            nullptr,
+            &error
+        )
+        || !g_output_stream_write_all(
+            self->stream,
+            record->tag,
+            tag_length,
+            nullptr,
+            nullptr,
+            &error
+        ))
+    {
+        g_warning("Failed to write trace record: %s", error->message);
+        self->failed = true;
+    }
+}
+
+static gboolean rmf_binary_trace_sink_wants_text(RmfTraceSink *)
+{
+    return FALSE;
+}
+
+static void rmf_binary_trace_sink_iface_init(RmfTraceSinkInterface *iface)
+{
+    iface->record = rmf_binary_trace_sink_record;
+    iface->wants_text = rmf_binary_trace_sink_wants_text;
+}
+
+static void rmf_binary_trace_sink_class_init(RmfBinaryTraceSinkClass *klass)
+{
+    auto const oclass = G_OBJECT_CLASS(klass);
+    oclass->dispose = rmf_binary_trace_sink_dispose;
+    oclass->set_property = rmf_binary_trace_sink_set_property;
+
+    /**
+     * RmfBinaryTraceSink:stream
+     *
+     * The stream records are written to.
+     */
+    obj_properties[PROP_STREAM] = g_param_spec_object(
+        "stream",
+        nullptr,
+        nullptr,
+        G_TYPE_OUTPUT_STREAM,
+        G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS
+    );
+
+    g_object_class_install_properties(oclass, N_PROPERTIES, obj_properties);
+}
+
+static void rmf_binary_trace_sink_init(RmfBinaryTraceSink *)
+{
+}
+
+/**
+ * rmf_binary_trace_sink_new:
+ * @stream: Stream to write records to.
+ *
+ * Creates a new [class@RmfBinaryTraceSink].
+ *
+ * Returns: The new [class@RmfBinaryTraceSink].
+ */
+RmfBinaryTraceSink *rmf_binary_trace_sink_new(GOutputStream *stream)
+{
+    g_return_val_if_fail(G_IS_OUTPUT_STREAM(stream), nullptr);
+    return g_object_new(RMF_TYPE_BINARY_TRACE_SINK, "stream", stream, nullptr);
+}
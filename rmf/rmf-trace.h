@@ -0,0 +1,81 @@
+#ifndef RMF_TRACE_H
+#define RMF_TRACE_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include <gio/gio.h>
+#include <glib-object.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+// RmfTraceKind
+
+#define RMF_TYPE_TRACE_KIND rmf_trace_kind_get_type()
+
+typedef enum {
+    RMF_TRACE_KIND_BEGIN,
+    RMF_TRACE_KIND_ONELINE,
+    RMF_TRACE_KIND_END,
+} RmfTraceKind;
+
+GType rmf_trace_kind_get_type(void);
+
+// RmfTraceRecord
+
+typedef struct {
+    RmfTraceKind kind;
+    char const *source;
+    goffset offset;
+    guint depth;
+    char const *tag;
+    char const *attributes;
+    char const *content;
+} RmfTraceRecord;
+
+// RmfTraceSink
+
+#define RMF_TYPE_TRACE_SINK rmf_trace_sink_get_type()
+G_DECLARE_INTERFACE(RmfTraceSink, rmf_trace_sink, RMF, TRACE_SINK, GObject)
+
+struct _RmfTraceSinkInterface {
+    GTypeInterface parent;
+
+    void (*record)(RmfTraceSink *sink, RmfTraceRecord const *record);
+    gboolean (*wants_text)(RmfTraceSink *sink);
+};
+
+void rmf_trace_sink_record(RmfTraceSink *sink, RmfTraceRecord const *record);
+gboolean rmf_trace_sink_wants_text(RmfTraceSink *sink);
+
+// RmfXmlTraceSink
+
+#define RMF_TYPE_XML_TRACE_SINK rmf_xml_trace_sink_get_type()
+G_DECLARE_FINAL_TYPE(
+    RmfXmlTraceSink,
+    rmf_xml_trace_sink,
+    RMF,
+    XML_TRACE_SINK,
+    GObject
+)
+
+RmfXmlTraceSink *rmf_xml_trace_sink_new(void);
+
+// RmfBinaryTraceSink
+
+#define RMF_TYPE_BINARY_TRACE_SINK rmf_binary_trace_sink_get_type()
+G_DECLARE_FINAL_TYPE(
+    RmfBinaryTraceSink,
+    rmf_binary_trace_sink,
+    RMF,
+    BINARY_TRACE_SINK,
+    GObject
+)
+
+RmfBinaryTraceSink *rmf_binary_trace_sink_new(GOutputStream *stream);
+
+G_END_DECLS
+
+#endif
@@ -5,6 +5,7 @@
 
 #include <glib-object.h>
 #include <glib.h>
+#include <math.h>
 
 void rmf_read_byte(RmfLoader *self, rmf_byte *b)
 {
@@ -25,10 +26,62 @@ void rmf_read_float(RmfLoader *self, rmf_float *f)
 void rmf_read_nstring(RmfLoader *rmf, rmf_nstring *nstring)
 {
     rmf_read_byte(rmf, &nstring->length);
-    g_assert(nstring->length > 0);
     rmf_loader_read(rmf, nstring->length, nstring->data);
-    bool const is_null_terminated = nstring->data[nstring->length - 1] == '\0';
-    g_assert(is_null_terminated);
+    bool const is_null_terminated
+        = nstring->length > 0 && nstring->data[nstring->length - 1] == '\0';
+    if (G_UNLIKELY(!is_null_terminated)) {
+        rmf_loader_fail(
+            rmf,
+            RMF_LOADER_ERROR_INVALID,
+            "String is not null-terminated"
+        );
+        nstring->length = 0;
+        nstring->data[0] = '\0';
+    }
+}
+
+// Read a string which likely repeats, eg. a key or classname.
+char const *rmf_read_interned_nstring(RmfLoader *self)
+{
+    rmf_nstring nstring;
+    rmf_read_nstring(self, &nstring);
+    return rmf_loader_intern(
+        self,
+        (guint8 const *)nstring.data,
+        nstring.length
+    );
+}
+
+// Read a string which is likely unique, eg. a value, into a record of its own.
+char const *rmf_read_copied_nstring(RmfLoader *self)
+{
+    rmf_nstring nstring;
+    rmf_read_nstring(self, &nstring);
+    auto const length = MAX(nstring.length, 1) - 1;
+    return rmf_arena_strndup(self->arena, nstring.data, length);
+}
+
+void rmf_skip_nstring(RmfLoader *self)
+{
+    rmf_byte length = 0;
+    rmf_read_byte(self, &length);
+    rmf_loader_seek(self, length);
+}
+
+// Read an element count, checking that @size bytes per element could actually
+// be left in the data. Keeps corrupt counts from driving huge allocations.
+void rmf_read_count(RmfLoader *self, rmf_int *n, size_t size)
+{
+    rmf_read_int(self, n);
+    if (G_UNLIKELY(*n > rmf_loader_get_remaining(self) / MAX(size, 1))) {
+        rmf_loader_fail(
+            self,
+            RMF_LOADER_ERROR_TRUNCATED,
+            "Count %u exceeds the remaining data",
+            *n
+        );
+        *n = 0;
+    }
 }
 
 /**
@@ -78,3 +131,109 @@ void rmf_vector_free(RmfVector *vector)
 {
     g_free(vector);
 }
+
+/**
+ * RmfBounds:
+ * @min: The lowest coordinates on each axis.
+ * @max: The highest coordinates on each axis.
+ *
+ * An axis-aligned bounding box. Empty bounds have @min above @max.
+ */
+G_DEFINE_BOXED_TYPE(RmfBounds, rmf_bounds, rmf_bounds_copy, rmf_bounds_free)
+
+RmfBounds *rmf_bounds_copy(RmfBounds *bounds)
+{
+    RmfBounds *out = g_new(RmfBounds, 1);
+    memcpy(out, bounds, sizeof(RmfBounds));
+    return out;
+}
+
+void rmf_bounds_free(RmfBounds *bounds)
+{
+    g_free(bounds);
+}
+
+/**
+ * rmf_bounds_is_empty:
+ * @bounds: The bounds.
+ *
+ * Checks whether the bounds contain no points at all.
+ *
+ * Returns: `TRUE` if the bounds are empty.
+ */
+gboolean rmf_bounds_is_empty(RmfBounds const *bounds)
+{
+    g_return_val_if_fail(bounds != nullptr, TRUE);
+    return bounds->min.x > bounds->max.x || bounds->min.y > bounds->max.y
+        || bounds->min.z > bounds->max.z;
+}
+
+void rmf_bounds_clear(RmfBounds *self)
+{
+    *self = (RmfBounds){
+        .min = {INFINITY, INFINITY, INFINITY},
+        .max = {-INFINITY, -INFINITY, -INFINITY},
+    };
+}
+
+// Grow @self to take in @n packed RmfVectors at @points, which need not be
+// aligned.
+//
+// Four points make twelve floats, which the compiler keeps as three 4-wide
+// vectors and takes the minimum and maximum of in one instruction each. Lane i
+// of the block holds axis i % 3, so the lanes are folded by axis at the end.
+// Written with comparisons rather than fminf() and fmaxf(), which vectorise
+// without -ffast-math and skip NaN coordinates the same way.
+void rmf_bounds_add_points(RmfBounds *self, void const *points, size_t n)
+{
+    constexpr size_t BLOCK = 4 * 3;
+    auto const bytes = (guint8 const *)points;
+
+    rmf_float lo[BLOCK];
+    rmf_float hi[BLOCK];
+    rmf_float const min[3] = {self->min.x, self->min.y, self->min.z};
+    rmf_float const max[3] = {self->max.x, self->max.y, self->max.z};
+    for (size_t i = 0; i < BLOCK; ++i) {
+        lo[i] = min[i % 3];
+        hi[i] = max[i % 3];
+    }
+
+    auto const n_blocks = n / 4;
+    for (size_t b = 0; b < n_blocks; ++b) {
+        rmf_float block[BLOCK];
+        memcpy(block, bytes + b * sizeof(block), sizeof(block));
+        for (size_t i = 0; i < BLOCK; ++i) {
+            lo[i] = block[i] < lo[i] ? block[i] : lo[i];
+            hi[i] = block[i] > hi[i] ? block[i] : hi[i];
+        }
+    }
+
+    // The last few points go into the first lanes.
+    auto const tail = (n - n_blocks * 4) * 3;
+    rmf_float block[BLOCK];
+    memcpy(block, bytes + n_blocks * sizeof(block), tail * sizeof(rmf_float));
+    for (size_t i = 0; i < tail; ++i) {
+        lo[i] = block[i] < lo[i] ? block[i] : lo[i];
+        hi[i] = block[i] > hi[i] ? block[i] : hi[i];
+    }
+
+    rmf_float axes_lo[3] = {lo[0], lo[1], lo[2]};
+    rmf_float axes_hi[3] = {hi[0], hi[1], hi[2]};
+    for (size_t i = 3; i < BLOCK; ++i) {
+        axes_lo[i % 3] = MIN(axes_lo[i % 3], lo[i]);
+        axes_hi[i % 3] = MAX(axes_hi[i % 3], hi[i]);
+    }
+    self->min = (RmfVector){axes_lo[0], axes_lo[1], axes_lo[2]};
+    self->max = (RmfVector){axes_hi[0], axes_hi[1], axes_hi[2]};
+}
+
+// Grow @self to take in @other.
+void rmf_bounds_union(RmfBounds *self, RmfBounds const *other)
+{
+    self->min.x = MIN(self->min.x, other->min.x);
+    self->min.y = MIN(self->min.y, other->min.y);
+    self->min.z = MIN(self->min.z, other->min.z);
+    self->max.x = MAX(self->max.x, other->max.x);
+    self->max.y = MAX(self->max.y, other->max.y);
+    self->max.z = MAX(self->max.z, other->max.z);
+}
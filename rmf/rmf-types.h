@@ -42,4 +42,18 @@ GType rmf_vector_get_type(void);
 RmfVector *rmf_vector_copy(RmfVector *vector);
 void rmf_vector_free(RmfVector *vector);
 
+// RmfBounds
+
+#define RMF_TYPE_BOUNDS rmf_bounds_get_type()
+
+typedef struct {
+    RmfVector min;
+    RmfVector max;
+} RmfBounds;
+
+GType rmf_bounds_get_type(void);
+RmfBounds *rmf_bounds_copy(RmfBounds *bounds);
+void rmf_bounds_free(RmfBounds *bounds);
+gboolean rmf_bounds_is_empty(RmfBounds const *bounds);
+
 #endif
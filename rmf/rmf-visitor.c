@@ -0,0 +1,358 @@
+#include "rmf/rmf-visitor.h"
+
+#include "rmf/rmf-private.h"
+
+#include <glib-object.h>
+#include <glib.h>
+
+/**
+ * RmfVisitResult:
+ * @RMF_VISIT_CONTINUE: Carry on with the walk.
+ * @RMF_VISIT_SKIP_CHILDREN: Don't visit the descendants of this object. Same
+ *   as @RMF_VISIT_CONTINUE when visiting in post-order, since they have been
+ *   visited already.
+ * @RMF_VISIT_STOP: End the walk.
+ *
+ * What an [struct@RmfVisitor] callback wants to happen next.
+ */
+G_DEFINE_ENUM_TYPE(
+    RmfVisitResult,
+    rmf_visit_result,
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_CONTINUE, "continue"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_SKIP_CHILDREN, "skip-children"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_STOP, "stop")
+)
+
+/**
+ * RmfVisitFlags:
+ * @RMF_VISIT_FLAGS_WORLD: Visit the [class@RmfWorldspawn].
+ * @RMF_VISIT_FLAGS_SOLIDS: Visit [class@RmfSolid]s.
+ * @RMF_VISIT_FLAGS_ENTITIES: Visit [class@RmfEntity]s.
+ * @RMF_VISIT_FLAGS_GROUPS: Visit [class@RmfGroup]s.
+ * @RMF_VISIT_FLAGS_ALL: Visit objects of every type.
+ * @RMF_VISIT_FLAGS_POST_ORDER: Visit each object after its descendants rather
+ *   than before.
+ *
+ * Flags controlling a walk with [method@RmfMapObject.visit]. Objects of the
+ * types left out are not visited, but their descendants are.
+ */
+G_DEFINE_FLAGS_TYPE(
+    RmfVisitFlags,
+    rmf_visit_flags,
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_WORLD, "world"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_SOLIDS, "solids"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_ENTITIES, "entities"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_GROUPS, "groups"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_ALL, "all"),
+    G_DEFINE_ENUM_VALUE(RMF_VISIT_FLAGS_POST_ORDER, "post-order")
+)
+
+/**
+ * RmfVisitor:
+ * @world: (nullable): Called for the [class@RmfWorldspawn].
+ * @solid: (nullable): Called for each [class@RmfSolid].
+ * @entity: (nullable): Called for each [class@RmfEntity].
+ * @group: (nullable): Called for each [class@RmfGroup].
+ *
+ * Callbacks for a walk with [method@RmfMapObject.visit], one per type of map
+ * object. Objects are passed as borrowed references. Types without a callback
+ * are not visited, but their descendants are.
+ */
+
+// One object on the path from the start of the walk to the current object.
+typedef struct {
+    RmfMapObject *object;
+    RmfMapObject *const *children;
+    guint n_children;
+    guint next_child;
+} Frame;
+
+/**
+ * RmfParallelVisitFunc:
+ * @map_object: (transfer none): The object being visited.
+ * @slot: (nullable): The reduction slot of the calling thread, or `NULL` if
+ *   the slots are empty.
+ * @user_data: (closure): User data passed to
+ *   [method@RmfMapObject.visit_parallel].
+ *
+ * Called for each object of a parallel walk, from any thread.
+ */
+
+/**
+ * RmfReduceFunc:
+ * @slot: A reduction slot.
+ * @user_data: (closure): User data passed to
+ *   [method@RmfMapObject.visit_parallel].
+ *
+ * Called once for each reduction slot at the end of a parallel walk, on the
+ * calling thread, to fold it into the overall result.
+ */
+
+// Keep reduction slots on separate cache lines, so that threads don't contend
+// for them.
+#define SLOT_ALIGNMENT 64
+
+// Roughly how many tasks to make per worker, so that threads which finish
+// their subtrees early have something left to pick up.
+#define TASKS_PER_WORKER 8
+
+typedef struct {
+    RmfVisitFlags flags;
+    RmfParallelVisitFunc visit;
+    gsize slot_stride;
+    guint8 *slots;
+    gpointer user_data;
+    GPtrArray *tasks; // Subtrees, each walked by one thread.
+} ParallelVisit;
+
+// Private /////////////////////////////////////////////////////////////////////
+
+static RmfVisitResult visit_object(
+    RmfMapObject *object,
+    RmfVisitor const *visitor,
+    RmfVisitFlags flags,
+    gpointer user_data
+)
+{
+    switch (rmf_map_object_get_object_type(object)) {
+    case RMF_OBJECT_TYPE_WORLD:
+        if ((flags & RMF_VISIT_FLAGS_WORLD) && visitor->world != nullptr) {
+            return visitor->world(RMF_WORLDSPAWN(object), user_data);
+        }
+        break;
+    case RMF_OBJECT_TYPE_SOLID:
+        if ((flags & RMF_VISIT_FLAGS_SOLIDS) && visitor->solid != nullptr) {
+            return visitor->solid(RMF_SOLID(object), user_data);
+        }
+        break;
+    case RMF_OBJECT_TYPE_ENTITY:
+        if ((flags & RMF_VISIT_FLAGS_ENTITIES) && visitor->entity != nullptr) {
+            return visitor->entity(RMF_ENTITY(object), user_data);
+        }
+        break;
+    case RMF_OBJECT_TYPE_GROUP:
+        if ((flags & RMF_VISIT_FLAGS_GROUPS) && visitor->group != nullptr) {
+            return visitor->group(RMF_GROUP(object), user_data);
+        }
+        break;
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+    return RMF_VISIT_CONTINUE;
+}
+
+static bool is_visited(RmfMapObject *object, RmfVisitFlags flags)
+{
+    switch (rmf_map_object_get_object_type(object)) {
+    case RMF_OBJECT_TYPE_WORLD:
+        return flags & RMF_VISIT_FLAGS_WORLD;
+    case RMF_OBJECT_TYPE_SOLID:
+        return flags & RMF_VISIT_FLAGS_SOLIDS;
+    case RMF_OBJECT_TYPE_ENTITY:
+        return flags & RMF_VISIT_FLAGS_ENTITIES;
+    case RMF_OBJECT_TYPE_GROUP:
+        return flags & RMF_VISIT_FLAGS_GROUPS;
+    case RMF_OBJECT_TYPE_UNKNOWN:
+        break;
+    }
+    return false;
+}
+
+static void parallel_visit_tasks(
+    guint begin,
+    guint end,
+    guint worker,
+    gpointer user_data
+)
+{
+    ParallelVisit const *pv = user_data;
+    auto const slot
+        = pv->slots ? pv->slots + worker * pv->slot_stride : nullptr;
+
+    g_autoptr(GPtrArray) stack = g_ptr_array_new();
+    for (guint i = begin; i < end; ++i) {
+        g_ptr_array_add(stack, g_ptr_array_index(pv->tasks, i));
+        while (stack->len > 0) {
+            RmfMapObject *object = g_ptr_array_steal_index_fast(
+                stack,
+                stack->len - 1
+            );
+            if (is_visited(object, pv->flags)) {
+                pv->visit(object, slot, pv->user_data);
+            }
+            guint n_children;
+            auto const children
+                = rmf_map_object_get_child_array(object, &n_children);
+            for (guint j = 0; j < n_children; ++j) {
+                g_ptr_array_add(stack, children[j]);
+            }
+        }
+    }
+}
+
+// Public //////////////////////////////////////////////////////////////////////
+
+/**
+ * rmf_map_object_visit:
+ * @map_object: The object to start from.
+ * @visitor: Callbacks to call for each type of object.
+ * @flags: Which types of object to visit, and in which order.
+ * @user_data: (closure): User data passed to the callbacks.
+ *
+ * Walks @map_object and all of its descendants depth-first, calling the
+ * callback of @visitor matching the type of each object.
+ *
+ * The walk keeps its own stack rather than recursing, and steps through the
+ * children arrays in place, so it makes no iterators.
+ *
+ * Returns: `FALSE` if a callback stopped the walk, `TRUE` otherwise.
+ */
+gboolean rmf_map_object_visit(
+    RmfMapObject *self,
+    RmfVisitor const *visitor,
+    RmfVisitFlags flags,
+    gpointer user_data
+)
+{
+    g_return_val_if_fail(RMF_IS_MAP_OBJECT(self), FALSE);
+    g_return_val_if_fail(visitor != nullptr, FALSE);
+
+    bool const post_order = flags & RMF_VISIT_FLAGS_POST_ORDER;
+    g_autoptr(GArray) stack = g_array_new(FALSE, FALSE, sizeof(Frame));
+    RmfMapObject *entering = self;
+
+    while (entering != nullptr || stack->len > 0) {
+        if (entering != nullptr) {
+            if (!post_order) {
+                auto const result
+                    = visit_object(entering, visitor, flags, user_data);
+                if (result == RMF_VISIT_STOP) {
+                    return FALSE;
+                }
+                if (result == RMF_VISIT_SKIP_CHILDREN) {
+                    entering = nullptr;
+                    continue;
+                }
+            }
+            Frame frame = {.object = entering};
+            frame.children
+                = rmf_map_object_get_child_array(entering, &frame.n_children);
+            g_array_append_val(stack, frame);
+            entering = nullptr;
+            continue;
+        }
+
+        auto const top = &g_array_index(stack, Frame, stack->len - 1);
+        if (top->next_child < top->n_children) {
+            entering = top->children[top->next_child++];
+            continue;
+        }
+
+        // All children done, leave the object.
+        auto const leaving = top->object;
+        g_array_set_size(stack, stack->len - 1);
+        if (post_order
+            && visit_object(leaving, visitor, flags, user_data)
+                   == RMF_VISIT_STOP)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * rmf_map_object_visit_parallel:
+ * @map_object: The object to start from.
+ * @flags: Which types of object to visit. The order flag is ignored.
+ * @visit: (scope call): Function to call for each object.
+ * @reduce: (nullable) (scope call): Function to call for each reduction slot
+ *   once the walk is done.
+ * @slot_size: Size of a reduction slot in bytes. May be zero, in which case
+ *   @visit is passed `NULL` and @reduce is not called.
+ * @user_data: (closure): User data passed to @visit and @reduce.
+ *
+ * Calls @visit for @map_object and each of its descendants, spread over a
+ * shared thread pool and the calling thread. Objects are visited exactly once,
+ * in no particular order, and the walk can't be pruned or stopped.
+ *
+ * The tree is split into subtrees near the top, and idle threads pick up the
+ * next unclaimed subtree until none are left. The objects above the split are
+ * visited on the calling thread first.
+ *
+ * Each thread accumulates into its own zeroed reduction slot of @slot_size
+ * bytes, so @visit needs no locking as long as it only writes to its slot.
+ * Afterwards, @reduce is called on the calling thread with each slot in turn.
+ */
+void rmf_map_object_visit_parallel(
+    RmfMapObject *self,
+    RmfVisitFlags flags,
+    RmfParallelVisitFunc visit,
+    RmfReduceFunc reduce,
+    gsize slot_size,
+    gpointer user_data
+)
+{
+    g_return_if_fail(RMF_IS_MAP_OBJECT(self));
+    g_return_if_fail(visit != nullptr);
+
+    auto const n_workers = rmf_parallel_n_workers();
+    auto const stride
+        = (slot_size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+    guint8 *slots = nullptr;
+    if (slot_size > 0) {
+        slots = g_aligned_alloc0(n_workers, stride, SLOT_ALIGNMENT);
+    }
+
+    g_autoptr(GPtrArray) tasks = g_ptr_array_new();
+    g_autoptr(GPtrArray) next = g_ptr_array_new();
+    g_ptr_array_add(tasks, self);
+
+    // Split the top of the tree level by level until there are enough
+    // subtrees to go around, visiting each object split up.
+    auto const n_tasks = n_workers * TASKS_PER_WORKER;
+    for (bool split = true; split && tasks->len < n_tasks;) {
+        split = false;
+        g_ptr_array_set_size(next, 0);
+        for (guint i = 0; i < tasks->len; ++i) {
+            RmfMapObject *object = g_ptr_array_index(tasks, i);
+            guint n_children;
+            auto const children
+                = rmf_map_object_get_child_array(object, &n_children);
+            if (n_children == 0) {
+                g_ptr_array_add(next, object);
+                continue;
+            }
+            if (is_visited(object, flags)) {
+                visit(object, slots, user_data);
+            }
+            for (guint j = 0; j < n_children; ++j) {
+                g_ptr_array_add(next, children[j]);
+            }
+            split = true;
+        }
+        if (split) {
+            auto const tmp = tasks;
+            tasks = next;
+            next = tmp;
+        }
+    }
+
+    ParallelVisit pv = {
+        .flags = flags,
+        .visit = visit,
+        .slot_stride = stride,
+        .slots = slots,
+        .user_data = user_data,
+        .tasks = tasks,
+    };
+    auto const grain = MAX(tasks->len / n_tasks, 1);
+    rmf_parallel_for(tasks->len, grain, parallel_visit_tasks, &pv);
+
+    if (reduce != nullptr && slots != nullptr) {
+        for (guint i = 0; i < n_workers; ++i) {
+            reduce(slots + i * stride, user_data);
+        }
+    }
+    g_aligned_free(slots);
+}
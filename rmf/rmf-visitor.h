@@ -0,0 +1,81 @@
+#ifndef RMF_VISITOR_H
+#define RMF_VISITOR_H
+
+#if !defined(__RMF_H_INSIDE__) && !defined(RMF_COMPILATION)
+#  error "Only <rmf.h> can be included directly."
+#endif
+
+#include "rmf/rmf-entity.h"
+#include "rmf/rmf-group.h"
+#include "rmf/rmf-mapobject.h"
+#include "rmf/rmf-solid.h"
+#include "rmf/rmf-worldspawn.h"
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+// RmfVisitResult
+
+#define RMF_TYPE_VISIT_RESULT rmf_visit_result_get_type()
+
+typedef enum {
+    RMF_VISIT_CONTINUE,
+    RMF_VISIT_SKIP_CHILDREN,
+    RMF_VISIT_STOP,
+} RmfVisitResult;
+
+GType rmf_visit_result_get_type(void);
+
+// RmfVisitFlags
+
+#define RMF_TYPE_VISIT_FLAGS rmf_visit_flags_get_type()
+
+typedef enum {
+    RMF_VISIT_FLAGS_WORLD = 1 << 0,
+    RMF_VISIT_FLAGS_SOLIDS = 1 << 1,
+    RMF_VISIT_FLAGS_ENTITIES = 1 << 2,
+    RMF_VISIT_FLAGS_GROUPS = 1 << 3,
+    RMF_VISIT_FLAGS_ALL = 0xf,
+    RMF_VISIT_FLAGS_POST_ORDER = 1 << 4,
+} RmfVisitFlags;
+
+GType rmf_visit_flags_get_type(void);
+
+// RmfVisitor
+
+typedef struct {
+    RmfVisitResult (*world)(RmfWorldspawn *world, gpointer user_data);
+    RmfVisitResult (*solid)(RmfSolid *solid, gpointer user_data);
+    RmfVisitResult (*entity)(RmfEntity *entity, gpointer user_data);
+    RmfVisitResult (*group)(RmfGroup *group, gpointer user_data);
+} RmfVisitor;
+
+gboolean rmf_map_object_visit(
+    RmfMapObject *map_object,
+    RmfVisitor const *visitor,
+    RmfVisitFlags flags,
+    gpointer user_data
+);
+
+// Parallel visits
+
+typedef void (*RmfParallelVisitFunc)(
+    RmfMapObject *map_object,
+    gpointer slot,
+    gpointer user_data
+);
+typedef void (*RmfReduceFunc)(gpointer slot, gpointer user_data);
+
+void rmf_map_object_visit_parallel(
+    RmfMapObject *map_object,
+    RmfVisitFlags flags,
+    RmfParallelVisitFunc visit,
+    RmfReduceFunc reduce,
+    gsize slot_size,
+    gpointer user_data
+);
+
+G_END_DECLS
+
+#endif
@@ -37,7 +37,6 @@ RMF_DEFINE_ITERATOR_TYPE(
  */
 struct _RmfWorldspawn {
     RmfEntityData parent_instance;
-    GPtrArray *paths;
 };
 
 enum Property {
@@ -50,18 +49,17 @@ static GParamSpec *obj_properties[N_PROPERTIES];
 
 G_DEFINE_FINAL_TYPE(RmfWorldspawn, rmf_worldspawn, RMF_TYPE_ENTITY_DATA)
 
-// GObject /////////////////////////////////////////////////////////////////////
+// Private /////////////////////////////////////////////////////////////////////
 
-static void rmf_worldspawn_dispose(GObject *object)
+static GPtrArray *get_paths(RmfWorldspawn *self)
 {
-    auto self = RMF_WORLDSPAWN(object);
-    if (self->paths) {
-        g_ptr_array_unref(self->paths);
-        self->paths = nullptr;
-    }
-    G_OBJECT_CLASS(rmf_worldspawn_parent_class)->dispose(object);
+    RmfModel *model = nullptr;
+    auto const node = rmf_map_object_peek_node(RMF_MAP_OBJECT(self), &model);
+    return model ? rmf_model_entity(model, node->payload)->paths : nullptr;
 }
 
+// GObject /////////////////////////////////////////////////////////////////////
+
 static void rmf_worldspawn_get_property(
     GObject *object,
     guint property_id,
@@ -70,12 +68,13 @@ static void rmf_worldspawn_get_property(
 )
 {
     auto const self = RMF_WORLDSPAWN(object);
+    auto const paths = get_paths(self);
     switch ((enum Property)property_id) {
     case PROP_N_PATHS:
-        g_value_set_uint(value, self->paths->len);
+        g_value_set_uint(value, paths ? paths->len : 0);
         break;
     case PROP_PATHS:
-        g_value_take_object(value, rmf_path_iterator_new(self->paths));
+        g_value_take_object(value, rmf_path_iterator_new(paths, self));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
@@ -83,40 +82,11 @@ static void rmf_worldspawn_get_property(
     }
 }
 
-// RmfMapObject ////////////////////////////////////////////////////////////////
-
-static void rmf_worldspawn_load(RmfMapObject *map_object, RmfLoader *loader)
-{
-    rmf_loader_log_begin(loader, "worldspawn", nullptr);
-    auto const self = RMF_WORLDSPAWN(map_object);
-
-    RMF_MAP_OBJECT_CLASS(rmf_worldspawn_parent_class)->load(map_object, loader);
-
-    auto object_type = rmf_map_object_get_object_type(map_object);
-    g_return_if_fail(object_type == RMF_OBJECT_TYPE_WORLD);
-
-    rmf_int n_paths;
-    rmf_read_int(loader, &n_paths);
-    rmf_loader_log_begin(loader, "paths", "count", "%u", n_paths, nullptr);
-
-    self->paths = g_ptr_array_new_full(n_paths, (GDestroyNotify)rmf_path_free);
-    for (rmf_int i = 0; i < n_paths; ++i) {
-        RmfPath *path = rmf_path_new(loader);
-        g_ptr_array_add(self->paths, path);
-    }
-    rmf_loader_log_end(loader);
-    rmf_loader_log_end(loader);
-}
-
 // RmfWorldspawn ///////////////////////////////////////////////////////////////
 
 static void rmf_worldspawn_class_init(RmfWorldspawnClass *klass)
 {
-    auto moclass = RMF_MAP_OBJECT_CLASS(klass);
-    moclass->load = rmf_worldspawn_load;
-
     auto const oclass = G_OBJECT_CLASS(klass);
-    oclass->dispose = rmf_worldspawn_dispose;
     oclass->get_property = rmf_worldspawn_get_property;
 
     /**
@@ -166,9 +136,9 @@ static void rmf_worldspawn_init(RmfWorldspawn *)
  */
 rmf_int rmf_worldspawn_get_n_paths(RmfWorldspawn *self)
 {
-    rmf_int value = 0;
-    g_object_get(self, "n-paths", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_WORLDSPAWN(self), 0);
+    auto const paths = get_paths(self);
+    return paths ? paths->len : 0;
 }
 
 /**
@@ -181,16 +151,60 @@ rmf_int rmf_worldspawn_get_n_paths(RmfWorldspawn *self)
  */
 RmfPathIterator *rmf_worldspawn_get_paths(RmfWorldspawn *self)
 {
-    RmfPathIterator *value = nullptr;
-    g_object_get(self, "paths", &value, nullptr);
-    return value;
+    g_return_val_if_fail(RMF_IS_WORLDSPAWN(self), nullptr);
+    return rmf_path_iterator_new(get_paths(self), self);
+}
+
+/**
+ * rmf_worldspawn_get_path_array
+ * @worldspawn: The worldspawn.
+ * @n_paths: (out): Return location for the number of paths.
+ *
+ * Gets the [struct@RmfPath]s associated with the object as an array, without
+ * making an iterator.
+ *
+ * Returns: (transfer none) (array length=n_paths) (nullable): The paths, valid
+ * as long as the world.
+ */
+RmfPath *const *
+rmf_worldspawn_get_path_array(RmfWorldspawn *self, guint *n_paths)
+{
+    g_return_val_if_fail(RMF_IS_WORLDSPAWN(self), nullptr);
+    g_return_val_if_fail(n_paths != nullptr, nullptr);
+    return (RmfPath *const *)rmf_ptr_array_span(get_paths(self), n_paths);
 }
 
 // Internal ////////////////////////////////////////////////////////////////////
 
-RmfWorldspawn *rmf_worldspawn_new(RmfLoader *loader)
+rmf_int rmf_worldspawn_read(RmfLoader *loader)
+{
+    auto const model = loader->model;
+    auto const index = model->entities->len;
+    g_array_set_size(model->entities, index + 1);
+    auto const record = rmf_model_entity(model, index);
+
+    rmf_entity_data_read(loader, record);
+
+    rmf_int n_paths;
+    rmf_read_count(loader, &n_paths, 1);
+    RMF_TRACE_BEGIN(loader, "paths", "count=\"%u\"", n_paths);
+
+    record->paths
+        = g_ptr_array_new_full(n_paths, (GDestroyNotify)rmf_path_free);
+    for (rmf_int i = 0; i < n_paths; ++i) {
+        RmfPath *path = rmf_path_new(loader);
+        g_ptr_array_add(record->paths, path);
+    }
+    RMF_TRACE_END(loader);
+    return index;
+}
+
+void rmf_worldspawn_skip(RmfLoader *loader)
 {
-    RmfWorldspawn *self = g_object_new(RMF_TYPE_WORLDSPAWN, nullptr);
-    rmf_worldspawn_load(RMF_MAP_OBJECT(self), loader);
-    return self;
+    rmf_entity_data_skip(loader);
+    rmf_int n_paths = 0;
+    rmf_read_count(loader, &n_paths, 1);
+    for (rmf_int i = 0; i < n_paths && !rmf_loader_failed(loader); ++i) {
+        rmf_skip_path(loader);
+    }
 }
@@ -39,6 +39,8 @@ G_DECLARE_FINAL_TYPE(
 
 rmf_int rmf_worldspawn_get_n_paths(RmfWorldspawn *worldspawn);
 RmfPathIterator *rmf_worldspawn_get_paths(RmfWorldspawn *worldspawn);
+RmfPath *const *
+rmf_worldspawn_get_path_array(RmfWorldspawn *worldspawn, guint *n_paths);
 
 G_END_DECLS
 
@@ -3,16 +3,28 @@
 
 #define __RMF_H_INSIDE__
 
+#include <rmf/rmf-bvh.h>
 #include <rmf/rmf-entity.h>
 #include <rmf/rmf-entitydata.h>
+#include <rmf/rmf-frustum.h>
+#include <rmf/rmf-geometry.h>
 #include <rmf/rmf-group.h>
 #include <rmf/rmf-iterator.h>
+#include <rmf/rmf-kdtree.h>
 #include <rmf/rmf-loader.h>
 #include <rmf/rmf-mapobject.h>
+#include <rmf/rmf-model.h>
+#include <rmf/rmf-node.h>
+#include <rmf/rmf-overlap.h>
+#include <rmf/rmf-planetable.h>
+#include <rmf/rmf-ray.h>
 #include <rmf/rmf-root.h>
 #include <rmf/rmf-solid.h>
+#include <rmf/rmf-stringpool.h>
 #include <rmf/rmf-structs.h>
+#include <rmf/rmf-trace.h>
 #include <rmf/rmf-types.h>
+#include <rmf/rmf-visitor.h>
 #include <rmf/rmf-worldspawn.h>
 
 #undef __RMF_H_INSIDE__